@@ -0,0 +1,152 @@
+#include "batch_queue.hpp"
+#include "../threading/thread_pool.hpp"
+#include "../cache/grid_cache.hpp"
+#include "../cache/hash.hpp"
+#include "../pathfinder/pathfinder.hpp"
+#include "../profiler/profiler.hpp"
+
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+
+bool BatchQueue::Item::IsFinished() const {
+    return status.load() >= Status::Solved;
+}
+
+BatchQueue::BatchQueue(ThreadPool& pool, const GridCache* grid_cache)
+    : _pool(pool), _grid_cache(grid_cache), _pending(0) {
+}
+
+BatchQueue::~BatchQueue() {
+    Wait();
+}
+
+size_t BatchQueue::AddFolder(const std::string& folder, const ThresholdSettings& threshold) {
+    std::error_code error;
+    std::vector<std::filesystem::path> files;
+
+    for (const auto& entry : std::filesystem::directory_iterator(folder, error)) {
+        if (!entry.is_regular_file()) continue;
+
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg") {
+            files.push_back(entry.path());
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    for (const std::filesystem::path& file : files) {
+        AddFile(file.string(), threshold);
+    }
+
+    return files.size();
+}
+
+void BatchQueue::AddFile(const std::string& filename, const ThresholdSettings& threshold) {
+    _items.push_back(std::make_unique<Item>());
+    Item* item = _items.back().get();
+    item->filename = filename;
+    item->threshold = threshold;
+
+    ++_pending;
+    _pool.Submit([this, item] {
+        Process(*item);
+
+        if (--_pending == 0) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _drained.notify_all();
+        }
+    });
+}
+
+void BatchQueue::Clear() {
+    Wait();
+    _items.clear();
+}
+
+void BatchQueue::Wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _drained.wait(lock, [this] { return _pending.load() == 0; });
+}
+
+size_t BatchQueue::GetItemCount() const {
+    return _items.size();
+}
+
+size_t BatchQueue::GetFinishedCount() const {
+    return _items.size() - _pending.load();
+}
+
+bool BatchQueue::IsBusy() const {
+    return _pending.load() > 0;
+}
+
+const BatchQueue::Item& BatchQueue::GetItem(size_t index) const {
+    return *_items[index];
+}
+
+const char* BatchQueue::GetStatusName(Status status) {
+    switch (status) {
+    case Status::Queued:      return "Queued";
+    case Status::Loading:     return "Loading";
+    case Status::Converting:  return "Converting";
+    case Status::Solving:     return "Solving";
+    case Status::Solved:      return "Solved";
+    case Status::NoEndpoints: return "No endpoints";
+    case Status::NoPath:      return "No path";
+    case Status::Failed:      return "Failed";
+    }
+    return "Unknown";
+}
+
+void BatchQueue::Process(Item& item) {
+    ProfileZone zone("Batch Item");
+
+    item.status = Status::Loading;
+    Image image;
+    if (!image.LoadFromFile(item.filename)) {
+        item.status = Status::Failed;
+        return;
+    }
+
+    image.ApplyGreyscaleFilter();
+
+    item.status = Status::Converting;
+    uint64_t source_hash = item.threshold.Hash(image.GetSourceHash());
+    std::vector<std::vector<int>> maze;
+    std::vector<int32_t> components;
+    std::pair<ImVec2, ImVec2> bounding_box;
+    if (_grid_cache && _grid_cache->Load(source_hash, maze, components, bounding_box)) {
+        image.SetBoundingBox(bounding_box);
+    }
+    else {
+        maze = image.ConvertToMazeGrid(item.threshold);
+        components = Pathfinder::LabelComponents(maze);
+
+        if (_grid_cache) {
+            _grid_cache->Store(source_hash, maze, components, image.CalculateMazeBoundingBox());
+        }
+    }
+    item.maze_hash = HashMazeGrid(maze);
+
+    auto [top_left, bottom_right] = image.CalculateMazeBoundingBox();
+    if (!Pathfinder::FindBorderOpenings(maze, top_left, bottom_right, item.start_pos, item.end_pos)) {
+        item.status = Status::NoEndpoints;
+        return;
+    }
+
+    item.status = Status::Solving;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (Pathfinder::CanReach(components, image.GetWidth(), item.start_pos, item.end_pos)) {
+        item.path = Pathfinder::SolveMazeWithAStar(maze, item.start_pos, item.end_pos);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    item.solve_time = std::chrono::duration<double, std::milli>(end - start).count();
+
+    item.status = item.path.Empty() ? Status::NoPath : Status::Solved;
+}
\ No newline at end of file
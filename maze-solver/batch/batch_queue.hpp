@@ -0,0 +1,76 @@
+#ifndef BATCH_QUEUE_HPP
+#define BATCH_QUEUE_HPP
+
+#include "../image/image.hpp"
+#include "../path/path.hpp"
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+class ThreadPool;
+class GridCache;
+
+// Decodes, converts and solves a set of maze images in parallel on a thread pool.
+// Items never hold a texture; the viewer uploads only the item it shows.
+class BatchQueue {
+public:
+    enum class Status {
+        Queued = 0,
+        Loading,
+        Converting,
+        Solving,
+        Solved,
+        NoEndpoints,
+        NoPath,
+        Failed
+    };
+
+    struct Item {
+        std::string filename;
+        std::atomic<Status> status{ Status::Queued };
+        ThresholdSettings threshold;
+
+        // Only valid once IsFinished() returns true. Pixels and grids are dropped after
+        // solving; the viewer decodes the file again and reads the grid from the cache.
+        ImVec2 start_pos;
+        ImVec2 end_pos;
+        uint64_t maze_hash = 0;
+        CompactPath path;
+        double solve_time = 0.0;
+
+        bool IsFinished() const;
+    };
+
+    BatchQueue(ThreadPool& pool, const GridCache* grid_cache);
+    ~BatchQueue();
+
+    size_t AddFolder(const std::string& folder, const ThresholdSettings& threshold);
+    void AddFile(const std::string& filename, const ThresholdSettings& threshold);
+    void Clear();
+    void Wait();
+
+    size_t GetItemCount() const;
+    size_t GetFinishedCount() const;
+    bool IsBusy() const;
+    const Item& GetItem(size_t index) const;
+
+    static const char* GetStatusName(Status status);
+
+private:
+    void Process(Item& item);
+
+    ThreadPool& _pool;
+    const GridCache* _grid_cache;
+    std::vector<std::unique_ptr<Item>> _items;
+
+    std::atomic<size_t> _pending;
+    std::mutex _mutex;
+    std::condition_variable _drained;
+};
+
+#endif // BATCH_QUEUE_HPP
\ No newline at end of file
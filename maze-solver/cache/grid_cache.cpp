@@ -0,0 +1,141 @@
+#include "grid_cache.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <format>
+#include <thread>
+
+namespace {
+    constexpr uint32_t cache_magic = 0x43475a4d; // "MZGC"
+    constexpr uint32_t cache_version = 2;
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t source_hash;
+        int32_t width;
+        int32_t height;
+        int32_t bounds[4]; // min_x, min_y, max_x, max_y of the walls
+        uint64_t component_count;
+    };
+}
+
+GridCache::GridCache(const std::string& directory) {
+    _directory = directory;
+    _enabled = false;
+}
+
+std::filesystem::path GridCache::GetEntryPath(uint64_t source_hash) const {
+    return _directory / std::format("{:016x}.grid", source_hash);
+}
+
+bool GridCache::Load(uint64_t source_hash, std::vector<std::vector<int>>& maze, std::vector<int32_t>& components, std::pair<ImVec2, ImVec2>& bounding_box) const {
+    if (!_enabled) return false;
+
+    std::ifstream file(GetEntryPath(source_hash), std::ios::binary);
+    if (!file) return false;
+
+    CacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != cache_magic || header.version != cache_version || header.source_hash != source_hash)
+        return false;
+
+    if (header.width <= 0 || header.height <= 0)
+        return false;
+
+    // Walkability is stored as one bit per cell, row-major, followed by one label per cell.
+    // Sizes are checked against the file before anything is allocated from the header.
+    size_t cell_count = size_t(header.width) * size_t(header.height);
+    std::error_code error;
+    uintmax_t file_size = std::filesystem::file_size(GetEntryPath(source_hash), error);
+
+    if (error || header.component_count != cell_count || cell_count > file_size
+        || file_size != sizeof(header) + (cell_count + 7) / 8 + cell_count * sizeof(int32_t)) {
+        std::cerr << "[ERROR] Corrupt grid cache entry: " << GetEntryPath(source_hash).string() << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> bits((cell_count + 7) / 8);
+    file.read(reinterpret_cast<char*>(bits.data()), bits.size());
+
+    std::vector<int32_t> labels(cell_count);
+    file.read(reinterpret_cast<char*>(labels.data()), labels.size() * sizeof(int32_t));
+
+    if (!file) {
+        std::cerr << "[ERROR] Truncated grid cache entry: " << GetEntryPath(source_hash).string() << std::endl;
+        return false;
+    }
+
+    maze.assign(header.height, std::vector<int>(header.width, 0));
+    for (size_t i = 0; i < cell_count; ++i) {
+        maze[i / header.width][i % header.width] = (bits[i >> 3] >> (i & 7)) & 1;
+    }
+
+    components = std::move(labels);
+    bounding_box = { ImVec2(float(header.bounds[0]), float(header.bounds[1])), ImVec2(float(header.bounds[2]), float(header.bounds[3])) };
+    return true;
+}
+
+bool GridCache::Store(uint64_t source_hash, const std::vector<std::vector<int>>& maze, const std::vector<int32_t>& components, const std::pair<ImVec2, ImVec2>& bounding_box) const {
+    if (!_enabled || maze.empty() || maze[0].empty() || components.size() != maze.size() * maze[0].size()) return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    if (error) {
+        std::cerr << "[ERROR] Failed to create grid cache directory: " << error.message() << std::endl;
+        return false;
+    }
+
+    CacheHeader header{};
+    header.magic = cache_magic;
+    header.version = cache_version;
+    header.source_hash = source_hash;
+    header.width = static_cast<int32_t>(maze[0].size());
+    header.height = static_cast<int32_t>(maze.size());
+    header.component_count = components.size();
+    header.bounds[0] = int32_t(bounding_box.first.x);
+    header.bounds[1] = int32_t(bounding_box.first.y);
+    header.bounds[2] = int32_t(bounding_box.second.x);
+    header.bounds[3] = int32_t(bounding_box.second.y);
+
+    size_t cell_count = size_t(header.width) * size_t(header.height);
+    std::vector<unsigned char> bits((cell_count + 7) / 8, 0);
+    for (size_t i = 0; i < cell_count; ++i) {
+        if (maze[i / header.width][i % header.width] == 1) {
+            bits[i >> 3] |= static_cast<unsigned char>(1u << (i & 7));
+        }
+    }
+
+    // Write to a temporary file first so a crash never leaves a half-written entry
+    std::filesystem::path entry_path = GetEntryPath(source_hash);
+    std::filesystem::path temp_path = entry_path;
+    temp_path += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(bits.data()), bits.size());
+        file.write(reinterpret_cast<const char*>(components.data()), components.size() * sizeof(int32_t));
+
+        if (!file) {
+            std::cerr << "[ERROR] Failed to write grid cache entry: " << temp_path.string() << std::endl;
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, entry_path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+
+    return true;
+}
+
+void GridCache::SetEnabled(bool enabled) {
+    _enabled = enabled;
+}
+
+bool GridCache::IsEnabled() const {
+    return _enabled;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#ifndef GRID_CACHE_HPP
+#define GRID_CACHE_HPP
+
+#include <imgui.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <atomic>
+
+// Persistent on-disk cache of converted maze grids, their wall bounding box and
+// component labels, keyed by the decoded image hash mixed with the threshold settings
+class GridCache {
+public:
+    explicit GridCache(const std::string& directory);
+
+    bool Load(uint64_t source_hash, std::vector<std::vector<int>>& maze, std::vector<int32_t>& components, std::pair<ImVec2, ImVec2>& bounding_box) const;
+    bool Store(uint64_t source_hash, const std::vector<std::vector<int>>& maze, const std::vector<int32_t>& components, const std::pair<ImVec2, ImVec2>& bounding_box) const;
+
+    void SetEnabled(bool enabled);
+    bool IsEnabled() const;
+
+private:
+    std::filesystem::path GetEntryPath(uint64_t source_hash) const;
+
+    std::filesystem::path _directory;
+    std::atomic<bool> _enabled; // toggled from the GUI while batch workers read it
+};
+
+#endif // GRID_CACHE_HPP
\ No newline at end of file
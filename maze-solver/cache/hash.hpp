@@ -0,0 +1,39 @@
+#ifndef HASH_HPP
+#define HASH_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 64-bit FNV-1a, used as a content key for images, grids and cached results
+constexpr uint64_t fnv_offset_basis = 14695981039346656037ull;
+constexpr uint64_t fnv_prime = 1099511628211ull;
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = fnv_offset_basis) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= fnv_prime;
+    }
+
+    return hash;
+}
+
+inline uint64_t HashMazeGrid(const std::vector<std::vector<int>>& maze) {
+    uint64_t hash = fnv_offset_basis;
+
+    uint64_t rows = maze.size();
+    uint64_t cols = maze.empty() ? 0 : maze[0].size();
+    hash = HashBytes(&rows, sizeof(rows), hash);
+    hash = HashBytes(&cols, sizeof(cols), hash);
+
+    for (const std::vector<int>& row : maze) {
+        hash = HashBytes(row.data(), row.size() * sizeof(int), hash);
+    }
+
+    return hash;
+}
+
+#endif // HASH_HPP
\ No newline at end of file
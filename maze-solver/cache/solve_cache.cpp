@@ -0,0 +1,69 @@
+#include "solve_cache.hpp"
+#include "hash.hpp"
+
+bool SolveCache::Key::operator==(const Key& other) const {
+    return grid_hash == other.grid_hash
+        && start_x == other.start_x && start_y == other.start_y
+        && end_x == other.end_x && end_y == other.end_y
+        && algorithm == other.algorithm;
+}
+
+size_t SolveCache::KeyHasher::operator()(const Key& key) const {
+    int fields[5] = { key.start_x, key.start_y, key.end_x, key.end_y, key.algorithm };
+    return static_cast<size_t>(HashBytes(fields, sizeof(fields), key.grid_hash));
+}
+
+SolveCache::SolveCache(size_t capacity) {
+    _capacity = capacity > 0 ? capacity : 1;
+    _hits = 0;
+    _misses = 0;
+}
+
+const CompactPath* SolveCache::Find(const Key& key) {
+    auto it = _index.find(key);
+    if (it == _index.end()) {
+        ++_misses;
+        return nullptr;
+    }
+
+    // Move to the front so it is evicted last
+    _entries.splice(_entries.begin(), _entries, it->second);
+    ++_hits;
+    return &it->second->second;
+}
+
+void SolveCache::Insert(const Key& key, CompactPath path) {
+    auto it = _index.find(key);
+    if (it != _index.end()) {
+        it->second->second = std::move(path);
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+
+    _entries.emplace_front(key, std::move(path));
+    _index[key] = _entries.begin();
+
+    if (_entries.size() > _capacity) {
+        _index.erase(_entries.back().first);
+        _entries.pop_back();
+    }
+}
+
+void SolveCache::Clear() {
+    _entries.clear();
+    _index.clear();
+    _hits = 0;
+    _misses = 0;
+}
+
+size_t SolveCache::GetSize() const {
+    return _entries.size();
+}
+
+size_t SolveCache::GetHits() const {
+    return _hits;
+}
+
+size_t SolveCache::GetMisses() const {
+    return _misses;
+}
\ No newline at end of file
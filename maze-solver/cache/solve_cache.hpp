@@ -0,0 +1,47 @@
+#ifndef SOLVE_CACHE_HPP
+#define SOLVE_CACHE_HPP
+
+#include "../path/path.hpp"
+
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// Bounded LRU cache of solved paths keyed by grid content and endpoints
+class SolveCache {
+public:
+    struct Key {
+        uint64_t grid_hash;
+        int start_x, start_y;
+        int end_x, end_y;
+        int algorithm;
+
+        bool operator==(const Key& other) const;
+    };
+
+    explicit SolveCache(size_t capacity = 64);
+
+    const CompactPath* Find(const Key& key);
+    void Insert(const Key& key, CompactPath path);
+    void Clear();
+
+    size_t GetSize() const;
+    size_t GetHits() const;
+    size_t GetMisses() const;
+
+private:
+    struct KeyHasher {
+        size_t operator()(const Key& key) const;
+    };
+
+    using Entry = std::pair<Key, CompactPath>;
+
+    size_t _capacity;
+    size_t _hits;
+    size_t _misses;
+    std::list<Entry> _entries; // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHasher> _index;
+};
+
+#endif // SOLVE_CACHE_HPP
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "image.hpp"
+#include "../cache/hash.hpp"
+#include "../profiler/profiler.hpp"
 
 #include <tinyfiledialogs.h>
 #include <iostream>
@@ -12,6 +14,9 @@ Image::Image() {
     _texture = 0;
     _start_pos = ImVec2(0, 0);
     _end_pos = ImVec2(0, 0);
+    _source_hash = 0;
+    _preview_texture = 0;
+    _has_bounding_box = false;
 }
 
 Image::~Image() {
@@ -19,18 +24,41 @@ Image::~Image() {
 }
 
 bool Image::LoadTextureFromFile(const std::string& filename) {
-    int channels;
-    unsigned char* data = stbi_load(filename.c_str(), &_width, &_height, &channels, 4); // Load as RGBA
+    return LoadFromFile(filename) && UploadTexture();
+}
+
+// Decodes into CPU memory only, safe to call from worker threads
+bool Image::LoadFromFile(const std::string& filename) {
+    ProfileZone zone("Image Load");
+
+    int width, height, channels;
+    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 4); // Load as RGBA
 
     if (!data) {
         std::cerr << "[ERROR] Failed to load image: " << filename << std::endl;
         return false;
     }
 
+    _width = width;
+    _height = height;
+    _image_data.assign(data, data + (size_t(_width) * _height * 4));
+    _source_hash = HashBytes(_image_data.data(), _image_data.size());
+    _has_bounding_box = false;
+
+    stbi_image_free(data);
+    return true;
+}
+
+bool Image::UploadTexture() {
+    if (_image_data.empty()) return false;
+
+    ProfileZone zone("Texture Upload");
+
+    CleanupTexture();
+
     glGenTextures(1, &_texture);
     if (_texture == 0) {
         std::cerr << "[ERROR] glGenTextures failed!" << std::endl;
-        stbi_image_free(data);
         return false;
     }
 
@@ -39,12 +67,9 @@ bool Image::LoadTextureFromFile(const std::string& filename) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, _image_data.data());
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    _image_data.assign(data, data + (_width * _height * 4));
-
-    stbi_image_free(data);
     return true;
 }
 
@@ -53,6 +78,11 @@ void Image::CleanupTexture() {
         glDeleteTextures(1, &_texture);
         _texture = 0;
     }
+
+    if (_preview_texture) {
+        glDeleteTextures(1, &_preview_texture);
+        _preview_texture = 0;
+    }
 }
 
 void Image::SelectImageFromFileDialog() {
@@ -66,44 +96,36 @@ void Image::SelectImageFromFileDialog() {
 }
 
 void Image::UpdateTexture() {
-    if (_image_data.empty()) return;
+    if (_image_data.empty() || _texture == 0) return;
 
+    ProfileZone zone("Texture Upload");
     glBindTexture(GL_TEXTURE_2D, _texture);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, _image_data.data());
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-std::vector<unsigned char> Image::ExtractPixelData() {
-    if (_texture == 0) {
-        std::cerr << "[ERROR] Texture is not initialized!" << std::endl;
-        return {};
-    }
+// Works on the CPU copy, which always matches the texture, so no GL readback is needed
+std::vector<std::vector<int>> Image::ConvertToMazeGrid(const ThresholdSettings& settings) {
+    Thresholder thresholder;
+    thresholder.SetSource(_image_data, _width, _height);
+    return MaskToMazeGrid(thresholder.Apply(settings));
+}
 
-    glBindTexture(GL_TEXTURE_2D, _texture);
-    int image_size = _width * _height * 4; // 4 bytes per pixel (RGBA)
-    std::vector<unsigned char> pixel_data(image_size);
-    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel_data.data());
-    glBindTexture(GL_TEXTURE_2D, 0);
+std::vector<std::vector<int>> Image::MaskToMazeGrid(const std::vector<uint8_t>& walkable) {
+    if (walkable.size() != size_t(_width) * size_t(_height)) return {};
 
-    return pixel_data;
-}
+    ProfileZone zone("Grid Conversion");
 
-std::vector<std::vector<int>> Image::ConvertToMazeGrid() {
-    std::vector<unsigned char> pixel_data = ExtractPixelData();
     std::vector<std::vector<int>> maze_grid(_height, std::vector<int>(_width, 0));
 
     for (int y = 0; y < _height; ++y) {
         for (int x = 0; x < _width; ++x) {
-            int index = (y * _width + x) * 4;
-            unsigned char r = pixel_data[index];
-            unsigned char g = pixel_data[index + 1];
-            unsigned char b = pixel_data[index + 2];
-
-            bool is_white = (r > 150 && g > 150 && b > 150);
-            maze_grid[y][x] = is_white ? 1 : 0;
+            maze_grid[y][x] = walkable[size_t(y) * _width + x];
         }
     }
 
+    ProfileZone bounding_zone("Bounding Box");
+
     int min_x = _width, max_x = 0;
     int min_y = _height, max_y = 0;
 
@@ -126,10 +148,18 @@ std::vector<std::vector<int>> Image::ConvertToMazeGrid() {
         }
     }
 
+    SetBoundingBox({ ImVec2(min_x, min_y), ImVec2(max_x, max_y) });
     return maze_grid;
 }
 
+// Returns the wall extents found by the last conversion, falling back to the fixed classifier
 std::pair<ImVec2, ImVec2> Image::CalculateMazeBoundingBox() const {
+    if (_has_bounding_box) {
+        return _bounding_box;
+    }
+
+    ProfileZone zone("Bounding Box");
+
     int min_x = _width, min_y = _height;
     int max_x = 0, max_y = 0;
 
@@ -150,13 +180,56 @@ std::pair<ImVec2, ImVec2> Image::CalculateMazeBoundingBox() const {
         }
     }
 
-    return { ImVec2(min_x, min_y), ImVec2(max_x, max_y) };
+    _bounding_box = { ImVec2(min_x, min_y), ImVec2(max_x, max_y) };
+    _has_bounding_box = true;
+    return _bounding_box;
+}
+
+void Image::SetBoundingBox(const std::pair<ImVec2, ImVec2>& bounding_box) {
+    _bounding_box = bounding_box;
+    _has_bounding_box = true;
+}
+
+void Image::UpdatePreviewTexture(const std::vector<uint8_t>& walkable) {
+    if (walkable.size() != size_t(_width) * size_t(_height)) return;
+
+    ProfileZone zone("Texture Upload");
+
+    std::vector<unsigned char> preview(walkable.size() * 4);
+    for (size_t i = 0; i < walkable.size(); ++i) {
+        unsigned char value = walkable[i] ? 255 : 0;
+        preview[i * 4] = value;
+        preview[i * 4 + 1] = value;
+        preview[i * 4 + 2] = value;
+        preview[i * 4 + 3] = 255;
+    }
+
+    if (_preview_texture == 0) {
+        glGenTextures(1, &_preview_texture);
+        glBindTexture(GL_TEXTURE_2D, _preview_texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, preview.data());
+    }
+    else {
+        glBindTexture(GL_TEXTURE_2D, _preview_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, preview.data());
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+GLuint Image::GetPreviewTexture() const {
+    return _preview_texture;
 }
 
 
 void Image::ApplyGreyscaleFilter() {
     if (_image_data.empty()) return;
 
+    ProfileZone zone("Greyscale");
+
     for (size_t i = 0; i < _image_data.size(); i += 4) {
         unsigned char r = _image_data[i];
         unsigned char g = _image_data[i + 1];
@@ -186,6 +259,14 @@ int Image::GetHeight() const {
     return _height;
 }
 
+uint64_t Image::GetSourceHash() const {
+    return _source_hash;
+}
+
+const std::vector<unsigned char>& Image::GetImageData() const {
+    return _image_data;
+}
+
 ImVec2 Image::GetStartPosition() const {
     return _start_pos;
 }
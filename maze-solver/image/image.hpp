@@ -5,39 +5,57 @@
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <string>
+#include <cstdint>
+
+#include "threshold.hpp"
 
 class Image {
 public:
     Image();
     ~Image();
 
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
     bool LoadTextureFromFile(const std::string& filename);
+    bool LoadFromFile(const std::string& filename);
+    bool UploadTexture();
     void CleanupTexture();
     void SelectImageFromFileDialog();
 
-    std::vector<std::vector<int>> ConvertToMazeGrid();
+    std::vector<std::vector<int>> ConvertToMazeGrid(const ThresholdSettings& settings = ThresholdSettings());
+    std::vector<std::vector<int>> MaskToMazeGrid(const std::vector<uint8_t>& walkable);
+    void UpdatePreviewTexture(const std::vector<uint8_t>& walkable);
 
     GLuint GetTexture() const;
+    GLuint GetPreviewTexture() const;
     ImVec2 GetStartPosition() const;
     ImVec2 GetEndPosition() const;
     int GetWidth() const;
     int GetHeight() const;
+    uint64_t GetSourceHash() const;
+    const std::vector<unsigned char>& GetImageData() const;
 
     void SetStartPosition(ImVec2 start_pos);
     void SetEndPosition(ImVec2 end_pos);
 
     void ApplyGreyscaleFilter();
     std::pair<ImVec2, ImVec2> CalculateMazeBoundingBox() const;
+    void SetBoundingBox(const std::pair<ImVec2, ImVec2>& bounding_box);
 
 private:
     void UpdateTexture();
-    std::vector<unsigned char> ExtractPixelData();
 
     GLuint _texture;
+    GLuint _preview_texture;
     int _width;
     int _height;
     ImVec2 _start_pos;
     ImVec2 _end_pos;
+    uint64_t _source_hash;
+
+    mutable std::pair<ImVec2, ImVec2> _bounding_box;
+    mutable bool _has_bounding_box;
 
     std::vector<unsigned char> _image_data;
 };
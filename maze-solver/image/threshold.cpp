@@ -0,0 +1,246 @@
+#include "threshold.hpp"
+#include "../cache/hash.hpp"
+#include "../threading/thread_pool.hpp"
+#include "../profiler/profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Builds a (width + 1) x (height + 1) summed-area table; rows are prefixed in
+    // parallel, then column bands accumulate down the image in parallel
+    template <typename T, typename Value>
+    void BuildSummedArea(std::vector<T>& table, int width, int height, Value value) {
+        size_t stride = size_t(width) + 1;
+        table.assign(stride * (size_t(height) + 1), 0);
+
+        ThreadPool& pool = ThreadPool::Shared();
+
+        pool.ParallelFor(0, height, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y) {
+                T* row = &table[(y + 1) * stride];
+                T running = 0;
+                for (int x = 0; x < width; ++x) {
+                    running += value(y * width + x);
+                    row[x + 1] = running;
+                }
+            }
+        });
+
+        pool.ParallelFor(1, stride, [&](size_t begin, size_t end) {
+            for (size_t y = 2; y <= size_t(height); ++y) {
+                T* row = &table[y * stride];
+                const T* above = &table[(y - 1) * stride];
+                for (size_t x = begin; x < end; ++x) {
+                    row[x] += above[x];
+                }
+            }
+        });
+    }
+
+    template <typename T>
+    T WindowSum(const std::vector<T>& table, size_t stride, int x0, int y0, int x1, int y1) {
+        return table[size_t(y1) * stride + x1] - table[size_t(y0) * stride + x1]
+             - table[size_t(y1) * stride + x0] + table[size_t(y0) * stride + x0];
+    }
+}
+
+uint64_t ThresholdSettings::Hash(uint64_t seed) const {
+    int fields[5] = { int(mode), level, window_radius, open_radius, close_radius };
+    float factors[2] = { sauvola_k, bradley_t };
+    return HashBytes(factors, sizeof(factors), HashBytes(fields, sizeof(fields), seed));
+}
+
+bool ThresholdSettings::operator==(const ThresholdSettings& other) const {
+    return mode == other.mode && level == other.level && window_radius == other.window_radius
+        && sauvola_k == other.sauvola_k && bradley_t == other.bradley_t
+        && open_radius == other.open_radius && close_radius == other.close_radius;
+}
+
+Thresholder::Thresholder() {
+    _width = 0;
+    _height = 0;
+    _otsu_level = -1;
+}
+
+void Thresholder::SetSource(const std::vector<unsigned char>& rgba, int width, int height) {
+    Reset();
+    if (width <= 0 || height <= 0 || rgba.size() < size_t(width) * size_t(height) * 4) return;
+
+    _width = width;
+    _height = height;
+
+    size_t pixel_count = size_t(width) * size_t(height);
+    _luminance.resize(pixel_count);
+    _min_channel.resize(pixel_count);
+
+    ThreadPool::Shared().ParallelFor(0, pixel_count, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            unsigned char r = rgba[i * 4], g = rgba[i * 4 + 1], b = rgba[i * 4 + 2];
+            // Integer weights keep an already grey pixel at exactly its own value
+            _luminance[i] = static_cast<uint8_t>((299 * r + 587 * g + 114 * b) / 1000);
+            _min_channel[i] = std::min({ r, g, b });
+        }
+    });
+}
+
+void Thresholder::Reset() {
+    _width = 0;
+    _height = 0;
+    _otsu_level = -1;
+    _luminance.clear();
+    _min_channel.clear();
+    _sum.clear();
+    _sum_squares.clear();
+}
+
+bool Thresholder::HasSource() const {
+    return !_luminance.empty();
+}
+
+std::vector<uint8_t> Thresholder::Apply(const ThresholdSettings& settings) {
+    ProfileZone zone("Threshold");
+
+    std::vector<uint8_t> mask(_luminance.size(), 0);
+    if (mask.empty()) return mask;
+
+    switch (settings.mode) {
+    case ThresholdSettings::Mode::Fixed:
+        ApplyLevel(_min_channel, settings.level, mask);
+        break;
+    case ThresholdSettings::Mode::Otsu:
+        ApplyLevel(_luminance, GetOtsuLevel(), mask);
+        break;
+    case ThresholdSettings::Mode::Sauvola:
+    case ThresholdSettings::Mode::Bradley:
+        if (_sum.empty()) BuildIntegralImages();
+        ApplyLocal(settings, mask);
+        break;
+    }
+
+    // Opening drops walkable specks, closing fills wall specks. An element never needs to
+    // exceed the image, and the clamp keeps y + radius from overflowing on request input.
+    int max_radius = std::max(_width, _height);
+    int open_radius = std::min(settings.open_radius, max_radius);
+    int close_radius = std::min(settings.close_radius, max_radius);
+
+    if (open_radius > 0) {
+        Morphology(mask, open_radius, false);
+        Morphology(mask, open_radius, true);
+    }
+    if (close_radius > 0) {
+        Morphology(mask, close_radius, true);
+        Morphology(mask, close_radius, false);
+    }
+
+    return mask;
+}
+
+int Thresholder::GetOtsuLevel() {
+    if (_otsu_level < 0) _otsu_level = ComputeOtsuLevel();
+    return _otsu_level;
+}
+
+int Thresholder::ComputeOtsuLevel() const {
+    uint64_t histogram[256] = {};
+    for (uint8_t value : _luminance) {
+        ++histogram[value];
+    }
+
+    double total = double(_luminance.size());
+    double sum_all = 0.0;
+    for (int i = 0; i < 256; ++i) sum_all += double(i) * histogram[i];
+
+    double sum_background = 0.0, weight_background = 0.0;
+    double best_variance = -1.0;
+    int best_level = 127;
+
+    for (int level = 0; level < 256; ++level) {
+        weight_background += histogram[level];
+        if (weight_background == 0.0) continue;
+
+        double weight_foreground = total - weight_background;
+        if (weight_foreground == 0.0) break;
+
+        sum_background += double(level) * histogram[level];
+        double mean_background = sum_background / weight_background;
+        double mean_foreground = (sum_all - sum_background) / weight_foreground;
+
+        double variance = weight_background * weight_foreground * (mean_background - mean_foreground) * (mean_background - mean_foreground);
+        if (variance > best_variance) {
+            best_variance = variance;
+            best_level = level;
+        }
+    }
+
+    return best_level;
+}
+
+void Thresholder::BuildIntegralImages() {
+    BuildSummedArea(_sum, _width, _height, [&](size_t i) { return uint64_t(_luminance[i]); });
+    BuildSummedArea(_sum_squares, _width, _height, [&](size_t i) { return uint64_t(_luminance[i]) * _luminance[i]; });
+}
+
+void Thresholder::ApplyLevel(const std::vector<uint8_t>& channel, int level, std::vector<uint8_t>& mask) const {
+    ThreadPool::Shared().ParallelFor(0, channel.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            mask[i] = channel[i] > level ? 1 : 0;
+        }
+    });
+}
+
+void Thresholder::ApplyLocal(const ThresholdSettings& settings, std::vector<uint8_t>& mask) const {
+    size_t stride = size_t(_width) + 1;
+    int radius = std::clamp(settings.window_radius, 1, std::max(_width, _height));
+    bool sauvola = settings.mode == ThresholdSettings::Mode::Sauvola;
+
+    ThreadPool::Shared().ParallelFor(0, _height, [&](size_t begin, size_t end) {
+        for (int y = int(begin); y < int(end); ++y) {
+            int y0 = std::max(0, y - radius), y1 = std::min(_height, y + radius + 1);
+
+            for (int x = 0; x < _width; ++x) {
+                int x0 = std::max(0, x - radius), x1 = std::min(_width, x + radius + 1);
+
+                double count = double(x1 - x0) * double(y1 - y0);
+                double sum = double(WindowSum(_sum, stride, x0, y0, x1, y1));
+                double value = _luminance[size_t(y) * _width + x];
+
+                bool walkable;
+                if (sauvola) {
+                    double mean = sum / count;
+                    double variance = double(WindowSum(_sum_squares, stride, x0, y0, x1, y1)) / count - mean * mean;
+                    double deviation = std::sqrt(std::max(0.0, variance));
+                    walkable = value > mean * (1.0 + settings.sauvola_k * (deviation / 128.0 - 1.0));
+                }
+                else {
+                    walkable = value * count > sum * (1.0 - settings.bradley_t);
+                }
+
+                mask[size_t(y) * _width + x] = walkable ? 1 : 0;
+            }
+        }
+    });
+}
+
+// Square structuring element evaluated from a summed-area table of the mask
+void Thresholder::Morphology(std::vector<uint8_t>& mask, int radius, bool grow_walkable) const {
+    std::vector<uint32_t> table;
+    BuildSummedArea(table, _width, _height, [&](size_t i) { return uint32_t(mask[i]); });
+
+    size_t stride = size_t(_width) + 1;
+
+    ThreadPool::Shared().ParallelFor(0, _height, [&](size_t begin, size_t end) {
+        for (int y = int(begin); y < int(end); ++y) {
+            int y0 = std::max(0, y - radius), y1 = std::min(_height, y + radius + 1);
+
+            for (int x = 0; x < _width; ++x) {
+                int x0 = std::max(0, x - radius), x1 = std::min(_width, x + radius + 1);
+
+                uint32_t count = WindowSum(table, stride, x0, y0, x1, y1);
+                uint32_t area = uint32_t(x1 - x0) * uint32_t(y1 - y0);
+
+                mask[size_t(y) * _width + x] = grow_walkable ? (count > 0) : (count == area);
+            }
+        }
+    });
+}
\ No newline at end of file
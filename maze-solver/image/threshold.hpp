@@ -0,0 +1,58 @@
+#ifndef THRESHOLD_HPP
+#define THRESHOLD_HPP
+
+#include <vector>
+#include <cstdint>
+
+struct ThresholdSettings {
+    enum class Mode {
+        Fixed = 0, // every channel above level, the original classifier
+        Otsu,      // global level picked from the luminance histogram
+        Sauvola,   // local mean and deviation over a window
+        Bradley    // local mean over a window
+    };
+
+    Mode mode = Mode::Fixed;
+    int level = 150;
+    int window_radius = 15;
+    float sauvola_k = 0.2f;
+    float bradley_t = 0.15f;
+    int open_radius = 0;  // removes walkable specks smaller than the element
+    int close_radius = 0; // fills wall specks smaller than the element
+
+    uint64_t Hash(uint64_t seed) const;
+    bool operator==(const ThresholdSettings& other) const;
+};
+
+// Classifies RGBA pixels into walkable (1) and wall (0). Luminance and the integral
+// images are built once per source, so re-thresholding with new settings is O(1) per pixel.
+class Thresholder {
+public:
+    Thresholder();
+
+    void SetSource(const std::vector<unsigned char>& rgba, int width, int height);
+    void Reset();
+    bool HasSource() const;
+
+    std::vector<uint8_t> Apply(const ThresholdSettings& settings);
+    int GetOtsuLevel(); // computed once per source
+
+private:
+    int ComputeOtsuLevel() const;
+    void BuildIntegralImages();
+    void ApplyLevel(const std::vector<uint8_t>& channel, int level, std::vector<uint8_t>& mask) const;
+    void ApplyLocal(const ThresholdSettings& settings, std::vector<uint8_t>& mask) const;
+    void Morphology(std::vector<uint8_t>& mask, int radius, bool grow_walkable) const;
+
+    int _width;
+    int _height;
+    std::vector<uint8_t> _luminance;
+    std::vector<uint8_t> _min_channel; // r, g and b all exceed a level iff their minimum does
+    int _otsu_level;                   // -1 until first needed
+
+    // (width + 1) x (height + 1) summed-area tables of luminance and its square
+    std::vector<uint64_t> _sum;
+    std::vector<uint64_t> _sum_squares;
+};
+
+#endif // THRESHOLD_HPP
\ No newline at end of file
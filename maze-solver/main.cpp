@@ -1,7 +1,25 @@
 #include "window/window.hpp"
 #include "window/gui/gui.hpp"
+#include "server/server.hpp"
+#include "threading/thread_pool.hpp"
 
-int main() {
+#include <string>
+
+// --serve [address] runs the headless solver server instead of the GUI
+static int RunServer(const std::string& address) {
+    SolverServer server(ThreadPool::Shared());
+    if (!server.Listen(address)) {
+        return -1;
+    }
+
+    server.Run();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        return RunServer(argc > 2 ? argv[2] : "127.0.0.1:7878");
+    }
 
     Window window;
     GLFWwindow* glf_window = window.CreateWindow(1, 1, "Maze Solver");
@@ -13,7 +31,21 @@ int main() {
     gui.Init(glf_window);
 
     while (!window.ShouldClose(glf_window) && gui.IsRunning()) {
-        window.PollEvents();
+        // Block while nothing is happening instead of redrawing every frame
+        double timeout = gui.GetIdleTimeout();
+        if (timeout <= 0.0) {
+            window.PollEvents();
+        }
+        else {
+            window.WaitEvents(timeout);
+
+            if (gui.HasPendingEvents()) {
+                gui.RequestRedraw();
+            }
+            else if (!gui.IsBusy()) {
+                continue;
+            }
+        }
 
         gui.BeginFrame();
         gui.Render();
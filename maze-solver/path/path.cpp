@@ -0,0 +1,84 @@
+#include "path.hpp"
+
+CompactPath::CompactPath() {
+    _valid = false;
+    _start_x = 0;
+    _start_y = 0;
+    _move_count = 0;
+}
+
+CompactPath::CompactPath(int start_x, int start_y, size_t move_count) {
+    _valid = true;
+    _start_x = start_x;
+    _start_y = start_y;
+    _move_count = move_count;
+    _moves.assign((move_count + 3) / 4, 0);
+}
+
+void CompactPath::SetMove(size_t index, Direction direction) {
+    uint8_t& packed = _moves[index >> 2];
+    int shift = int(index & 3) * 2;
+    packed = static_cast<uint8_t>((packed & ~(3u << shift)) | (uint8_t(direction) << shift));
+}
+
+CompactPath::Direction CompactPath::GetMove(size_t index) const {
+    return static_cast<Direction>((_moves[index >> 2] >> ((index & 3) * 2)) & 3);
+}
+
+void CompactPath::PushMove(Direction direction) {
+    if ((_move_count & 3) == 0) {
+        _moves.push_back(0);
+    }
+
+    ++_move_count;
+    SetMove(_move_count - 1, direction);
+}
+
+void CompactPath::Clear() {
+    _valid = false;
+    _move_count = 0;
+    _moves.clear();
+    _moves.shrink_to_fit();
+}
+
+bool CompactPath::Empty() const {
+    return !_valid;
+}
+
+size_t CompactPath::GetLength() const {
+    return _valid ? _move_count + 1 : 0;
+}
+
+size_t CompactPath::GetMoveCount() const {
+    return _move_count;
+}
+
+size_t CompactPath::GetMemoryUsage() const {
+    return _moves.capacity();
+}
+
+ImVec2 CompactPath::GetStart() const {
+    return ImVec2(float(_start_x), float(_start_y));
+}
+
+ImVec2 CompactPath::GetEnd() const {
+    ImVec2 end;
+    ForEachCorner([&](int x, int y) { end = ImVec2(float(x), float(y)); });
+    return end;
+}
+
+std::vector<ImVec2> CompactPath::Expand() const {
+    std::vector<ImVec2> points;
+    points.reserve(GetLength());
+    ForEachPoint([&](int x, int y) { points.emplace_back(float(x), float(y)); });
+    return points;
+}
+
+void CompactPath::Step(Direction direction, int& x, int& y) {
+    switch (direction) {
+    case Direction::Up:    --y; break;
+    case Direction::Right: ++x; break;
+    case Direction::Down:  ++y; break;
+    case Direction::Left:  --x; break;
+    }
+}
\ No newline at end of file
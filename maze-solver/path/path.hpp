@@ -0,0 +1,81 @@
+#ifndef PATH_HPP
+#define PATH_HPP
+
+#include <imgui.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Four-connected path stored as a start cell plus a 2-bit move chain.
+// Points are expanded lazily, so a path costs a quarter byte per step
+// instead of the 8 bytes of a std::vector<ImVec2>.
+class CompactPath {
+public:
+    // Same order as FourConnected in search.hpp
+    enum class Direction : uint8_t {
+        Up = 0,
+        Right,
+        Down,
+        Left
+    };
+
+    CompactPath();
+    CompactPath(int start_x, int start_y, size_t move_count);
+
+    void SetMove(size_t index, Direction direction);
+    Direction GetMove(size_t index) const;
+    void PushMove(Direction direction);
+    void Clear();
+
+    bool Empty() const;
+    size_t GetLength() const;      // number of cells, including the start
+    size_t GetMoveCount() const;
+    size_t GetMemoryUsage() const; // bytes held by the move chain
+    ImVec2 GetStart() const;
+    ImVec2 GetEnd() const;
+
+    std::vector<ImVec2> Expand() const;
+
+    // Calls fn(x, y) for every cell along the path
+    template <typename Fn>
+    void ForEachPoint(Fn&& fn) const {
+        if (!_valid) return;
+
+        int x = _start_x, y = _start_y;
+        fn(x, y);
+
+        for (size_t i = 0; i < _move_count; ++i) {
+            Step(GetMove(i), x, y);
+            fn(x, y);
+        }
+    }
+
+    // Calls fn(x, y) for the start, every turn and the end, i.e. the run-length view of the path
+    template <typename Fn>
+    void ForEachCorner(Fn&& fn) const {
+        if (!_valid) return;
+
+        int x = _start_x, y = _start_y;
+        fn(x, y);
+
+        for (size_t i = 0; i < _move_count; ++i) {
+            Direction direction = GetMove(i);
+            Step(direction, x, y);
+
+            if (i + 1 == _move_count || GetMove(i + 1) != direction) {
+                fn(x, y);
+            }
+        }
+    }
+
+private:
+    static void Step(Direction direction, int& x, int& y);
+
+    bool _valid;
+    int32_t _start_x;
+    int32_t _start_y;
+    size_t _move_count;
+    std::vector<uint8_t> _moves; // four moves per byte, low bits first
+};
+
+#endif // PATH_HPP
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "path_export.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <format>
+#include <algorithm>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+namespace {
+    std::ofstream OpenExportFile(const std::string& filename) {
+        std::ofstream file(filename, std::ios::trunc);
+        if (!file) {
+            std::cerr << "[ERROR] Failed to open export file: " << filename << std::endl;
+        }
+        return file;
+    }
+
+    bool FinishExport(std::ofstream& file, const std::string& filename) {
+        file.flush();
+        if (!file) {
+            std::cerr << "[ERROR] Failed to write export file: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    unsigned char ToByte(float channel) {
+        return static_cast<unsigned char>(std::clamp(channel, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+bool PathExporter::ExportCsv(const CompactPath& path, const std::string& filename) {
+    std::ofstream file = OpenExportFile(filename);
+    if (!file) return false;
+
+    file << "step,x,y\n";
+
+    size_t step = 0;
+    path.ForEachPoint([&](int x, int y) {
+        file << step++ << ',' << x << ',' << y << '\n';
+    });
+
+    return FinishExport(file, filename);
+}
+
+bool PathExporter::ExportJson(const CompactPath& path, const std::string& filename) {
+    std::ofstream file = OpenExportFile(filename);
+    if (!file) return false;
+
+    file << "{\"length\":" << path.GetLength() << ",\"points\":[";
+
+    bool first = true;
+    path.ForEachPoint([&](int x, int y) {
+        file << (first ? "" : ",") << '[' << x << ',' << y << ']';
+        first = false;
+    });
+
+    file << "]}\n";
+
+    return FinishExport(file, filename);
+}
+
+bool PathExporter::ExportSvg(const CompactPath& path, int width, int height, ImVec4 color, float thickness, const std::string& filename) {
+    std::ofstream file = OpenExportFile(filename);
+    if (!file) return false;
+
+    file << std::format("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"{}\" height=\"{}\" viewBox=\"0 0 {} {}\">\n", width, height, width, height);
+    file << std::format("<polyline fill=\"none\" stroke=\"#{:02x}{:02x}{:02x}\" stroke-opacity=\"{:.2f}\" stroke-width=\"{:.1f}\" stroke-linejoin=\"round\" points=\"",
+        int(ToByte(color.x)), int(ToByte(color.y)), int(ToByte(color.z)), color.w, thickness);
+
+    // Straight runs collapse to their end points, the polyline is identical
+    path.ForEachCorner([&](int x, int y) {
+        file << x << ',' << y << ' ';
+    });
+
+    file << "\"/>\n</svg>\n";
+
+    return FinishExport(file, filename);
+}
+
+bool PathExporter::ExportPng(const CompactPath& path, const std::vector<unsigned char>& rgba, int width, int height,
+    ImVec4 color, int thickness, const std::string& filename) {
+    if (rgba.size() != size_t(width) * size_t(height) * 4) {
+        std::cerr << "[ERROR] No image data to annotate!" << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char> annotated = rgba;
+
+    auto Blend = [&](int cx, int cy, int radius, ImVec4 paint) {
+        for (int y = std::max(0, cy - radius); y <= std::min(height - 1, cy + radius); ++y) {
+            for (int x = std::max(0, cx - radius); x <= std::min(width - 1, cx + radius); ++x) {
+                unsigned char* pixel = &annotated[(size_t(y) * width + x) * 4];
+                pixel[0] = static_cast<unsigned char>(pixel[0] + (ToByte(paint.x) - pixel[0]) * paint.w);
+                pixel[1] = static_cast<unsigned char>(pixel[1] + (ToByte(paint.y) - pixel[1]) * paint.w);
+                pixel[2] = static_cast<unsigned char>(pixel[2] + (ToByte(paint.z) - pixel[2]) * paint.w);
+                pixel[3] = 255;
+            }
+        }
+    };
+
+    int radius = std::max(0, thickness / 2);
+    path.ForEachPoint([&](int x, int y) {
+        Blend(x, y, radius, color);
+    });
+
+    if (!path.Empty()) {
+        ImVec2 start = path.GetStart();
+        ImVec2 end = path.GetEnd();
+        Blend(int(start.x), int(start.y), radius + 2, ImVec4(0.0f, 1.0f, 0.0f, 1.0f));
+        Blend(int(end.x), int(end.y), radius + 2, ImVec4(1.0f, 0.0f, 0.0f, 1.0f));
+    }
+
+    if (!stbi_write_png(filename.c_str(), width, height, 4, annotated.data(), width * 4)) {
+        std::cerr << "[ERROR] Failed to write PNG: " << filename << std::endl;
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef PATH_EXPORT_HPP
+#define PATH_EXPORT_HPP
+
+#include "path.hpp"
+
+#include <imgui.h>
+#include <vector>
+#include <string>
+
+// Streams a CompactPath to disk without materialising the full point array
+class PathExporter {
+public:
+    static bool ExportCsv(const CompactPath& path, const std::string& filename);
+    static bool ExportJson(const CompactPath& path, const std::string& filename);
+    static bool ExportSvg(const CompactPath& path, int width, int height, ImVec4 color, float thickness, const std::string& filename);
+
+    // Draws the path and endpoint markers over a copy of the RGBA image and writes it as PNG
+    static bool ExportPng(const CompactPath& path, const std::vector<unsigned char>& rgba, int width, int height,
+        ImVec4 color, int thickness, const std::string& filename);
+};
+
+#endif // PATH_EXPORT_HPP
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "clearance.hpp"
+#include "../threading/thread_pool.hpp"
+#include "../profiler/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace {
+    constexpr int32_t no_wall = std::numeric_limits<int32_t>::max();
+}
+
+ClearanceMap::ClearanceMap() {
+    _valid = false;
+    _maze_hash = 0;
+    _width = _height = 0;
+    _max_clearance = 0.0f;
+    _build_time = 0.0;
+}
+
+// Two separable passes, both linear in the cell count: the distance to the nearest wall
+// along each column, then the lower envelope of the parabolas (x - q)^2 + column(q)^2
+// along each row (Felzenszwalb and Huttenlocher).
+void ClearanceMap::Build(const std::vector<std::vector<int>>& maze, uint64_t maze_hash, ThreadPool& pool) {
+    ProfileZone zone("Clearance Transform");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Invalidate();
+    if (maze.empty() || maze[0].empty()) return;
+
+    _height = static_cast<int>(maze.size());
+    _width = static_cast<int>(maze[0].size());
+    _maze_hash = maze_hash;
+
+    const int width = _width;
+    const int height = _height;
+
+    std::vector<int32_t> column(size_t(width) * size_t(height));
+
+    // Chunks are column ranges swept top-down then bottom-up, so every row segment stays contiguous
+    pool.ParallelFor(0, size_t(width), [&](size_t begin, size_t end) {
+        for (size_t x = begin; x < end; ++x) {
+            column[x] = maze[0][x] == 1 ? no_wall : 0;
+        }
+
+        for (int y = 1; y < height; ++y) {
+            int32_t* row = &column[size_t(y) * width];
+            const int32_t* above = row - width;
+
+            for (size_t x = begin; x < end; ++x) {
+                row[x] = maze[y][x] != 1 ? 0 : (above[x] == no_wall ? no_wall : above[x] + 1);
+            }
+        }
+
+        for (int y = height - 2; y >= 0; --y) {
+            int32_t* row = &column[size_t(y) * width];
+            const int32_t* below = row + width;
+
+            for (size_t x = begin; x < end; ++x) {
+                if (below[x] != no_wall && below[x] + 1 < row[x]) row[x] = below[x] + 1;
+            }
+        }
+    });
+
+    _clearance.resize(size_t(width) * size_t(height));
+
+    // A grid without walls has no finite distances; its diagonal stands in for infinity
+    const float open_clearance = std::hypot(float(width), float(height));
+    std::mutex max_mutex;
+
+    pool.ParallelFor(0, size_t(height), [&](size_t begin, size_t end) {
+        std::vector<int> parabolas(width);  // columns whose parabola is on the envelope
+        std::vector<double> bounds(width);  // left end of each envelope segment
+        float local_max = 0.0f;
+
+        for (size_t y = begin; y < end; ++y) {
+            const int32_t* g = &column[y * width];
+            float* out = &_clearance[y * width];
+
+            auto Height = [&](int q) {
+                return int64_t(g[q]) * g[q] + int64_t(q) * q;
+            };
+
+            int top = -1;
+            for (int q = 0; q < width; ++q) {
+                if (g[q] == no_wall) continue;
+
+                double s = 0.0;
+                while (top >= 0) {
+                    int p = parabolas[top];
+                    s = double(Height(q) - Height(p)) / (2.0 * (q - p));
+                    if (s > bounds[top]) break;
+                    --top;
+                }
+
+                ++top;
+                parabolas[top] = q;
+                bounds[top] = top == 0 ? -std::numeric_limits<double>::infinity() : s;
+            }
+
+            if (top < 0) {
+                std::fill(out, out + width, open_clearance);
+                local_max = open_clearance;
+                continue;
+            }
+
+            int segment = 0;
+            for (int x = 0; x < width; ++x) {
+                while (segment < top && bounds[segment + 1] < x) ++segment;
+
+                int p = parabolas[segment];
+                out[x] = std::sqrt(float(int64_t(x - p) * (x - p) + int64_t(g[p]) * g[p]));
+                local_max = std::max(local_max, out[x]);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(max_mutex);
+        _max_clearance = std::max(_max_clearance, local_max);
+    });
+
+    _valid = true;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    _build_time = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void ClearanceMap::Invalidate() {
+    _valid = false;
+    _max_clearance = 0.0f;
+    _clearance.clear();
+}
+
+bool ClearanceMap::IsValidFor(uint64_t maze_hash) const {
+    return _valid && _maze_hash == maze_hash;
+}
+
+float ClearanceMap::GetClearance(int x, int y) const {
+    if (!_valid || x < 0 || y < 0 || x >= _width || y >= _height)
+        return 0.0f;
+
+    return _clearance[size_t(y) * _width + x];
+}
+
+const float* ClearanceMap::GetData() const {
+    return _clearance.data();
+}
+
+// Searches square rings of growing radius; a ring can be skipped once its nearest
+// cell is farther away than the best match found so far
+bool ClearanceMap::Snap(ImVec2& pos, float min_clearance, const std::vector<int32_t>& components, const std::vector<size_t>& component_sizes, int max_radius) const {
+    if (!_valid) return false;
+
+    int cx = std::clamp(int(pos.x), 0, _width - 1);
+    int cy = std::clamp(int(pos.y), 0, _height - 1);
+
+    auto Nearest = [&](auto accept, int& out_x, int& out_y) {
+        int64_t best_distance = std::numeric_limits<int64_t>::max();
+        out_x = out_y = -1;
+
+        for (int r = 0; r <= max_radius; ++r) {
+            if (out_x >= 0 && int64_t(r) * r > best_distance)
+                break;
+
+            for (int dy = -r; dy <= r; ++dy) {
+                int step = (r == 0 || std::abs(dy) == r) ? 1 : 2 * r;
+
+                for (int dx = -r; dx <= r; dx += step) {
+                    int x = cx + dx, y = cy + dy;
+                    if (x < 0 || y < 0 || x >= _width || y >= _height) continue;
+
+                    size_t index = size_t(y) * _width + x;
+                    int64_t distance = int64_t(dx) * dx + int64_t(dy) * dy;
+                    if (distance < best_distance && _clearance[index] > 0.0f && accept(index)) {
+                        out_x = x;
+                        out_y = y;
+                        best_distance = distance;
+                    }
+                }
+            }
+        }
+
+        return out_x >= 0;
+    };
+
+    int open_x, open_y;
+    if (!Nearest([](size_t) { return true; }, open_x, open_y))
+        return false;
+
+    // Without labels for this grid every open cell counts as one large component
+    bool labelled = components.size() == _clearance.size();
+    auto IsSpeck = [&](size_t index) {
+        size_t label = size_t(components[index]);
+        return labelled && label < component_sizes.size() && component_sizes[label] < speck_cells;
+    };
+
+    size_t open_index = size_t(open_y) * _width + open_x;
+    int32_t component = labelled ? components[open_index] : 0;
+    bool speck = IsSpeck(open_index);
+
+    // A click in a real corridor stays in it, so a snap never jumps a thin wall into a
+    // corridor the click was not meant for. A speck holds no route, so its click moves on.
+    int best_x, best_y;
+    bool found = !speck && Nearest([&](size_t index) {
+        return _clearance[index] >= min_clearance && (!labelled || components[index] == component);
+    }, best_x, best_y);
+
+    if (!found) {
+        found = Nearest([&](size_t index) {
+            return _clearance[index] >= min_clearance && !IsSpeck(index);
+        }, best_x, best_y);
+    }
+
+    if (!found && speck) {
+        found = Nearest([&](size_t index) { return !IsSpeck(index); }, best_x, best_y);
+    }
+
+    if (!found) {
+        best_x = open_x;
+        best_y = open_y;
+    }
+
+    pos = ImVec2(float(best_x), float(best_y));
+    return true;
+}
+
+int ClearanceMap::GetWidth() const {
+    return _width;
+}
+
+int ClearanceMap::GetHeight() const {
+    return _height;
+}
+
+float ClearanceMap::GetMaxClearance() const {
+    return _max_clearance;
+}
+
+double ClearanceMap::GetBuildTime() const {
+    return _build_time;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#ifndef CLEARANCE_HPP
+#define CLEARANCE_HPP
+
+#include <imgui.h>
+#include <vector>
+#include <cstdint>
+
+class ThreadPool;
+
+// Exact Euclidean distance from every cell to the centre of the nearest wall cell,
+// 0 on walls. Built once per grid and used to keep endpoints and routes off the walls.
+class ClearanceMap {
+public:
+    static constexpr int snap_radius = 48;     // how far a clicked endpoint may be moved, in cells
+    static constexpr size_t speck_cells = 64;  // components smaller than this are treated as noise
+
+    ClearanceMap();
+
+    void Build(const std::vector<std::vector<int>>& maze, uint64_t maze_hash, ThreadPool& pool);
+    void Invalidate();
+
+    bool IsValidFor(uint64_t maze_hash) const;
+    float GetClearance(int x, int y) const; // 0 outside the grid
+    const float* GetData() const;           // flat, y * width + x
+
+    // Moves pos to the nearest cell with at least min_clearance, preferring the component of
+    // the nearest open cell. Clicks on specks, or in components with no such cell, may move
+    // to another component; otherwise the nearest open cell is kept, so a click in a corridor
+    // stays put. component_sizes comes from Pathfinder::MeasureComponents. False if all are walls.
+    bool Snap(ImVec2& pos, float min_clearance, const std::vector<int32_t>& components,
+        const std::vector<size_t>& component_sizes, int max_radius = snap_radius) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    float GetMaxClearance() const;
+    double GetBuildTime() const;
+
+private:
+    bool _valid;
+    uint64_t _maze_hash;
+    int _width, _height;
+    float _max_clearance;
+    double _build_time;
+    std::vector<float> _clearance;
+};
+
+#endif // CLEARANCE_HPP
\ No newline at end of file
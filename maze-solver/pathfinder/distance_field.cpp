@@ -0,0 +1,182 @@
+#include "distance_field.hpp"
+#include "search.hpp"
+#include "../threading/thread_pool.hpp"
+#include "../profiler/profiler.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+    // Below this the level is cheaper to expand on one thread than to hand out
+    constexpr size_t parallel_frontier_size = 4096;
+}
+
+DistanceField::DistanceField() {
+    _valid = false;
+    _maze_hash = 0;
+    _goal_x = _goal_y = -1;
+    _goal_walkable = false;
+    _width = _height = 0;
+    _build_time = 0.0;
+}
+
+// Level-synchronous breadth-first search; large frontiers are expanded in parallel
+// with cells claimed by compare-exchange so each is written exactly once
+void DistanceField::Build(const std::vector<std::vector<int>>& maze, uint64_t maze_hash, ImVec2 goal_pos, ThreadPool& pool) {
+    ProfileZone zone("Distance Field");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Invalidate();
+    if (maze.empty() || maze[0].empty()) return;
+
+    _height = static_cast<int>(maze.size());
+    _width = static_cast<int>(maze[0].size());
+    _goal_x = int(goal_pos.x);
+    _goal_y = int(goal_pos.y);
+    _maze_hash = maze_hash;
+
+    if (_goal_x < 0 || _goal_y < 0 || _goal_x >= _width || _goal_y >= _height) return;
+
+    const int width = _width;
+    const int height = _height;
+
+    _distance.assign(size_t(width) * size_t(height), unreachable);
+
+    std::vector<int32_t> frontier{ _goal_y * width + _goal_x };
+    std::vector<int32_t> next_frontier;
+    std::mutex merge_mutex;
+    _distance[frontier[0]] = 0;
+
+    // Like the solvers, a goal on a wall can only be reached by starting on it
+    _goal_walkable = maze[_goal_y][_goal_x] == 1;
+    if (!_goal_walkable) frontier.clear();
+
+    for (uint32_t level = 1; !frontier.empty(); ++level) {
+        next_frontier.clear();
+
+        auto Expand = [&](size_t begin, size_t end, std::vector<int32_t>& out) {
+            for (size_t i = begin; i < end; ++i) {
+                int32_t index = frontier[i];
+                int x = index % width;
+                int y = index / width;
+
+                for (int d = 0; d < FourConnected::count; ++d) {
+                    int nx = x + FourConnected::dx[d];
+                    int ny = y + FourConnected::dy[d];
+
+                    if (unsigned(nx) >= unsigned(width) || unsigned(ny) >= unsigned(height) || maze[ny][nx] != 1)
+                        continue;
+
+                    int32_t next = ny * width + nx;
+                    std::atomic_ref<uint32_t> cell(_distance[next]);
+                    uint32_t expected = unreachable;
+
+                    if (cell.load(std::memory_order_relaxed) == unreachable
+                        && cell.compare_exchange_strong(expected, level, std::memory_order_relaxed)) {
+                        out.push_back(next);
+                    }
+                }
+            }
+        };
+
+        if (frontier.size() < parallel_frontier_size) {
+            Expand(0, frontier.size(), next_frontier);
+        }
+        else {
+            pool.ParallelFor(0, frontier.size(), [&](size_t begin, size_t end) {
+                std::vector<int32_t> local;
+                local.reserve((end - begin) * 2);
+                Expand(begin, end, local);
+
+                std::lock_guard<std::mutex> lock(merge_mutex);
+                next_frontier.insert(next_frontier.end(), local.begin(), local.end());
+            });
+        }
+
+        frontier.swap(next_frontier);
+    }
+
+    _valid = true;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    _build_time = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void DistanceField::Invalidate() {
+    _valid = false;
+    _distance.clear();
+}
+
+bool DistanceField::IsValidFor(uint64_t maze_hash, ImVec2 goal_pos) const {
+    return _valid && _maze_hash == maze_hash && _goal_x == int(goal_pos.x) && _goal_y == int(goal_pos.y);
+}
+
+uint32_t DistanceField::GetDistance(int x, int y) const {
+    if (!_valid || x < 0 || y < 0 || x >= _width || y >= _height)
+        return unreachable;
+
+    return _distance[size_t(y) * _width + x];
+}
+
+CompactPath DistanceField::Descend(ImVec2 start_pos) const {
+    int x = int(start_pos.x), y = int(start_pos.y);
+
+    if (!_valid || x < 0 || y < 0 || x >= _width || y >= _height)
+        return {};
+
+    if (x == _goal_x && y == _goal_y)
+        return CompactPath(x, y, 0);
+
+    if (!_goal_walkable)
+        return {};
+
+    size_t move_count = GetDistance(x, y);
+
+    // A start on a wall steps onto its closest walkable neighbour first, like the solvers
+    if (move_count == unreachable) {
+        uint32_t via_neighbour = unreachable;
+        for (int d = 0; d < FourConnected::count; ++d) {
+            via_neighbour = std::min(via_neighbour, GetDistance(x + FourConnected::dx[d], y + FourConnected::dy[d]));
+        }
+
+        if (via_neighbour == unreachable)
+            return {};
+
+        move_count = size_t(via_neighbour) + 1;
+    }
+
+    CompactPath path(x, y, move_count);
+
+    for (size_t i = 0; i < move_count; ++i) {
+        uint32_t best = unreachable;
+        int best_direction = 0;
+
+        for (int d = 0; d < FourConnected::count; ++d) {
+            uint32_t neighbour = GetDistance(x + FourConnected::dx[d], y + FourConnected::dy[d]);
+            if (neighbour < best) {
+                best = neighbour;
+                best_direction = d;
+            }
+        }
+
+        path.SetMove(i, static_cast<CompactPath::Direction>(best_direction));
+        x += FourConnected::dx[best_direction];
+        y += FourConnected::dy[best_direction];
+    }
+
+    return path;
+}
+
+int DistanceField::GetWidth() const {
+    return _width;
+}
+
+int DistanceField::GetHeight() const {
+    return _height;
+}
+
+double DistanceField::GetBuildTime() const {
+    return _build_time;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef DISTANCE_FIELD_HPP
+#define DISTANCE_FIELD_HPP
+
+#include "../path/path.hpp"
+
+#include <imgui.h>
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+class ThreadPool;
+
+// Goal-rooted step distances over the whole grid. Built once per (grid, goal),
+// after which a path from any start is a gradient descent in O(path length).
+class DistanceField {
+public:
+    static constexpr uint32_t unreachable = std::numeric_limits<uint32_t>::max();
+
+    DistanceField();
+
+    void Build(const std::vector<std::vector<int>>& maze, uint64_t maze_hash, ImVec2 goal_pos, ThreadPool& pool);
+    void Invalidate();
+
+    bool IsValidFor(uint64_t maze_hash, ImVec2 goal_pos) const;
+    uint32_t GetDistance(int x, int y) const;
+    CompactPath Descend(ImVec2 start_pos) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    double GetBuildTime() const;
+
+private:
+    bool _valid;
+    uint64_t _maze_hash;
+    int _goal_x, _goal_y;
+    bool _goal_walkable;
+    int _width, _height;
+    double _build_time;
+    std::vector<uint32_t> _distance; // flat, y * width + x
+};
+
+#endif // DISTANCE_FIELD_HPP
\ No newline at end of file
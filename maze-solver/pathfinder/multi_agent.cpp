@@ -0,0 +1,579 @@
+#include "multi_agent.hpp"
+#include "search.hpp"
+#include "distance_field.hpp"
+#include "../cache/hash.hpp"
+#include "../threading/thread_pool.hpp"
+#include "../profiler/profiler.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <chrono>
+#include <limits>
+
+bool AgentPath::Empty() const {
+    return cells.empty();
+}
+
+size_t AgentPath::GetArrivalTime() const {
+    return cells.empty() ? 0 : cells.size() - 1;
+}
+
+int32_t AgentPath::GetCell(size_t time) const {
+    if (cells.empty()) return -1;
+    return cells[std::min(time, cells.size() - 1)];
+}
+
+CompactPath AgentPath::ToCompactPath(int width) const {
+    if (cells.empty()) return {};
+
+    CompactPath path(cells[0] % width, cells[0] / width, 0);
+
+    for (size_t t = 1; t < cells.size(); ++t) {
+        int32_t from = cells[t - 1];
+        int32_t to = cells[t];
+
+        if (to == from)
+            continue;
+        else if (to == from + width)
+            path.PushMove(CompactPath::Direction::Down);
+        else if (to == from - width)
+            path.PushMove(CompactPath::Direction::Up);
+        else if (to == from + 1)
+            path.PushMove(CompactPath::Direction::Right);
+        else
+            path.PushMove(CompactPath::Direction::Left);
+    }
+
+    return path;
+}
+
+ReservationTable::ReservationTable(size_t cell_count) {
+    _cell_count = cell_count;
+    _horizon = -1;
+}
+
+void ReservationTable::Clear() {
+    for (int32_t cell : _touched) {
+        _forever[cell] = std::numeric_limits<int32_t>::max();
+        _last_reserved[cell] = -1;
+        _last_move[cell] = -1;
+    }
+
+    _touched.clear();
+    _cells.clear();
+    _moves.clear();
+    _horizon = -1;
+}
+
+uint64_t ReservationTable::CellKey(int32_t cell, int32_t time) {
+    return (uint64_t(uint32_t(time)) << 32) | uint32_t(cell);
+}
+
+// The low two bits name the direction: moves only go to a four-connected neighbour,
+// so the sign and size of to - from tell them apart without knowing the width
+uint64_t ReservationTable::MoveKey(int32_t from, int32_t to, int32_t time) {
+    int32_t step = to - from;
+    uint64_t direction = step == 1 ? 0 : step == -1 ? 1 : step > 0 ? 2 : 3;
+    return (CellKey(from, time) << 2) | direction;
+}
+
+void ReservationTable::Touch(int32_t cell) {
+    if (_forever.empty()) {
+        _forever.assign(_cell_count, std::numeric_limits<int32_t>::max());
+        _last_reserved.assign(_cell_count, -1);
+        _last_move.assign(_cell_count, -1);
+    }
+
+    if (_last_reserved[cell] < 0 && _last_move[cell] < 0 && _forever[cell] == std::numeric_limits<int32_t>::max()) {
+        _touched.push_back(cell);
+    }
+}
+
+void ReservationTable::ReserveCell(int32_t cell, int32_t time) {
+    Touch(cell);
+    _cells.insert(CellKey(cell, time));
+    _last_reserved[cell] = std::max(_last_reserved[cell], time);
+    _horizon = std::max(_horizon, time);
+}
+
+void ReservationTable::ReserveMove(int32_t from, int32_t to, int32_t time) {
+    Touch(from);
+    _moves.insert(MoveKey(from, to, time));
+    _last_move[from] = std::max(_last_move[from], time);
+    _horizon = std::max(_horizon, time);
+}
+
+void ReservationTable::ReserveForever(int32_t cell, int32_t time) {
+    Touch(cell);
+    _forever[cell] = std::min(_forever[cell], time);
+    _horizon = std::max(_horizon, time);
+}
+
+// Occupies every cell along the route, blocks the reverse of each move so no one can
+// swap through the agent, and parks it on its goal for the rest of time
+void ReservationTable::ReservePath(const AgentPath& path) {
+    for (size_t t = 0; t < path.cells.size(); ++t) {
+        ReserveCell(path.cells[t], int32_t(t));
+
+        if (t > 0 && path.cells[t] != path.cells[t - 1]) {
+            ReserveMove(path.cells[t], path.cells[t - 1], int32_t(t - 1));
+        }
+    }
+
+    if (!path.Empty()) {
+        ReserveForever(path.cells.back(), int32_t(path.GetArrivalTime()));
+    }
+}
+
+bool ReservationTable::IsCellBlocked(int32_t cell, int32_t time) const {
+    if (_forever.empty()) return false;
+    if (time >= _forever[cell]) return true;
+    if (time > _last_reserved[cell]) return false;
+
+    return _cells.count(CellKey(cell, time)) != 0;
+}
+
+bool ReservationTable::IsMoveBlocked(int32_t from, int32_t to, int32_t time) const {
+    if (_last_move.empty() || time > _last_move[from]) return false;
+
+    return _moves.count(MoveKey(from, to, time)) != 0;
+}
+
+int32_t ReservationTable::GetLastReservedTime(int32_t cell) const {
+    if (_forever.empty()) return -1;
+    if (_forever[cell] != std::numeric_limits<int32_t>::max()) return std::numeric_limits<int32_t>::max();
+
+    return _last_reserved[cell];
+}
+
+int32_t ReservationTable::GetHorizon() const {
+    return _horizon;
+}
+
+MultiAgentPlanner::MultiAgentPlanner(const std::vector<std::vector<int>>& maze, ThreadPool& pool)
+    : _maze(maze), _pool(pool) {
+    _height = static_cast<int>(maze.size());
+    _width = maze.empty() ? 0 : static_cast<int>(maze[0].size());
+    _maze_hash = HashMazeGrid(maze);
+}
+
+bool MultiAgentPlanner::ToCell(ImVec2 pos, int32_t& cell) const {
+    int x = int(pos.x), y = int(pos.y);
+
+    if (x < 0 || y < 0 || x >= _width || y >= _height || _maze[y][x] != 1)
+        return false;
+
+    cell = y * _width + x;
+    return true;
+}
+
+size_t MultiAgentPlanner::GetFieldBudget() const {
+    size_t field_bytes = std::max<size_t>(1, size_t(_width) * size_t(_height) * sizeof(uint32_t));
+    return std::max<size_t>(1, field_budget_bytes / field_bytes);
+}
+
+MultiAgentPlanner::Result MultiAgentPlanner::Plan(const std::vector<Agent>& agents, Method method) {
+    ProfileZone zone("Multi-Agent Plan");
+
+    if (method == Method::ConflictBased && agents.size() <= cbs_agent_limit)
+        return PlanConflictBased(agents);
+
+    return PlanPrioritized(agents);
+}
+
+// Space-time A* over (cell, time) with a wait action. The exact goal distance of the
+// static grid is the heuristic, so the search only widens where reservations force a detour.
+bool MultiAgentPlanner::SearchAgent(int32_t start, int32_t goal, const DistanceField& heuristic, const ReservationTable& reservations, AgentPath& path, size_t& expanded) const {
+    struct Node {
+        int32_t cell;
+        int32_t time;
+        int32_t parent;
+    };
+
+    struct OpenEntry {
+        int32_t f;
+        int32_t time;
+        int32_t node;
+    };
+
+    struct Workspace {
+        std::vector<Node> nodes;
+        std::vector<OpenEntry> open;
+        std::unordered_set<uint64_t> closed;
+    };
+
+    // One workspace per thread, cleared but not freed between agents
+    thread_local Workspace workspace;
+    workspace.nodes.clear();
+    workspace.open.clear();
+    workspace.closed.clear();
+
+    path.cells.clear();
+
+    auto Heuristic = [&](int32_t cell) {
+        return heuristic.GetDistance(cell % _width, cell / _width);
+    };
+
+    // Lower f first, ties go to the deeper node
+    auto Compare = [](const OpenEntry& a, const OpenEntry& b) {
+        return a.f > b.f || (a.f == b.f && a.time < b.time);
+    };
+
+    uint32_t start_distance = Heuristic(start);
+    if (reservations.IsCellBlocked(start, 0) || start_distance == DistanceField::unreachable)
+        return false;
+
+    // Past the horizon only permanent reservations remain, so later timesteps collapse into one state
+    const int32_t horizon = reservations.GetHorizon();
+    const int32_t goal_free_after = reservations.GetLastReservedTime(goal);
+
+    // An agent walled in by parked ones would otherwise search every (cell, time) pair before
+    // giving up; the budget scales with the route length and the longest possible wait
+    const size_t max_expansions = 16 * (size_t(start_distance) + size_t(std::max(horizon, 0)) + 1) + 4096;
+
+    auto StateKey = [&](int32_t cell, int32_t time) {
+        return (uint64_t(uint32_t(std::min(time, horizon + 1))) << 32) | uint32_t(cell);
+    };
+
+    workspace.nodes.push_back(Node{ start, 0, -1 });
+    workspace.open.push_back(OpenEntry{ int32_t(Heuristic(start)), 0, 0 });
+
+    int32_t found = -1;
+    size_t expansions = 0;
+
+    while (!workspace.open.empty() && expansions < max_expansions) {
+        std::pop_heap(workspace.open.begin(), workspace.open.end(), Compare);
+        int32_t current = workspace.open.back().node;
+        workspace.open.pop_back();
+
+        Node node = workspace.nodes[current];
+        if (!workspace.closed.insert(StateKey(node.cell, node.time)).second)
+            continue;
+
+        ++expansions;
+
+        // Only stop where no one else will pass through later
+        if (node.cell == goal && node.time > goal_free_after) {
+            found = current;
+            break;
+        }
+
+        int x = node.cell % _width;
+        int y = node.cell / _width;
+        int32_t time = node.time + 1;
+
+        // The extra iteration is the wait action
+        for (int d = 0; d <= FourConnected::count; ++d) {
+            int32_t next = node.cell;
+
+            if (d < FourConnected::count) {
+                int nx = x + FourConnected::dx[d];
+                int ny = y + FourConnected::dy[d];
+
+                if (unsigned(nx) >= unsigned(_width) || unsigned(ny) >= unsigned(_height) || _maze[ny][nx] != 1)
+                    continue;
+
+                next = ny * _width + nx;
+
+                if (reservations.IsMoveBlocked(node.cell, next, node.time))
+                    continue;
+            }
+
+            if (reservations.IsCellBlocked(next, time) || workspace.closed.count(StateKey(next, time)))
+                continue;
+
+            uint32_t h = Heuristic(next);
+            if (h == DistanceField::unreachable)
+                continue;
+
+            workspace.nodes.push_back(Node{ next, time, current });
+            workspace.open.push_back(OpenEntry{ time + int32_t(h), time, int32_t(workspace.nodes.size() - 1) });
+            std::push_heap(workspace.open.begin(), workspace.open.end(), Compare);
+        }
+    }
+
+    expanded += expansions;
+
+    if (found < 0)
+        return false;
+
+    path.cells.resize(size_t(workspace.nodes[found].time) + 1);
+    for (int32_t index = found; index >= 0; index = workspace.nodes[index].parent) {
+        path.cells[workspace.nodes[index].time] = workspace.nodes[index].cell;
+    }
+
+    return true;
+}
+
+void MultiAgentPlanner::Finish(Result& result) const {
+    result.failed = 0;
+    result.makespan = 0;
+    result.sum_of_costs = 0;
+
+    for (const AgentPath& path : result.paths) {
+        if (path.Empty()) {
+            ++result.failed;
+            continue;
+        }
+
+        result.makespan = std::max(result.makespan, path.GetArrivalTime());
+        result.sum_of_costs += path.GetArrivalTime();
+    }
+}
+
+MultiAgentPlanner::Result MultiAgentPlanner::PlanPrioritized(const std::vector<Agent>& agents) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    Result result;
+    result.method = Method::Prioritized;
+    result.paths.resize(agents.size());
+
+    std::vector<int32_t> starts(agents.size(), -1);
+    std::vector<int32_t> goals(agents.size(), -1);
+    for (size_t i = 0; i < agents.size(); ++i) {
+        ToCell(agents[i].start, starts[i]);
+        ToCell(agents[i].goal, goals[i]);
+    }
+
+    ReservationTable reservations(size_t(_width) * size_t(_height));
+
+    // Heuristic fields for the next few agents are built together, the searches
+    // themselves must run in priority order against the growing reservation table.
+    // The slots are reused by every chunk, and large grids get fewer of them.
+    size_t chunk = std::min(std::max<size_t>(1, _pool.GetThreadCount()), GetFieldBudget());
+    std::vector<DistanceField> fields(std::min(chunk, agents.size()));
+
+    for (size_t first = 0; first < agents.size(); first += chunk) {
+        size_t last = std::min(agents.size(), first + chunk);
+
+        _pool.ParallelFor(first, last, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (starts[i] >= 0 && goals[i] >= 0) {
+                    fields[i - first].Build(_maze, _maze_hash, agents[i].goal, _pool);
+                }
+            }
+        });
+
+        for (size_t i = first; i < last; ++i) {
+            if (starts[i] < 0 || goals[i] < 0)
+                continue;
+
+            if (SearchAgent(starts[i], goals[i], fields[i - first], reservations, result.paths[i], result.expanded)) {
+                reservations.ReservePath(result.paths[i]);
+            }
+        }
+    }
+
+    Finish(result);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.plan_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    return result;
+}
+
+MultiAgentPlanner::Result MultiAgentPlanner::PlanConflictBased(const std::vector<Agent>& agents, size_t max_nodes) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    // A move constraint has to >= 0, a vertex constraint has to == -1
+    struct Constraint {
+        int32_t agent;
+        int32_t cell;
+        int32_t to;
+        int32_t time;
+    };
+
+    struct Node {
+        std::vector<Constraint> constraints;
+        std::vector<AgentPath> paths;
+        size_t cost = 0;
+    };
+
+    struct Conflict {
+        int32_t a, b;
+        int32_t cell, to;
+        int32_t time;
+    };
+
+    const size_t agent_count = agents.size();
+
+    Result result;
+    result.method = Method::ConflictBased;
+
+    std::vector<int32_t> starts(agent_count, -1);
+    std::vector<int32_t> goals(agent_count, -1);
+    for (size_t i = 0; i < agent_count; ++i) {
+        if (!ToCell(agents[i].start, starts[i]) || !ToCell(agents[i].goal, goals[i])) {
+            starts[i] = goals[i] = -1;
+        }
+    }
+
+    // Fields stay resident up to the budget, usually one per agent. On large grids the
+    // least recently used one is rebuilt for whichever agent CBS replans next.
+    const size_t slot_count = std::min(agent_count, GetFieldBudget());
+    std::vector<DistanceField> fields(slot_count);
+    std::vector<int32_t> field_agent(slot_count, -1);
+    std::vector<size_t> field_used(slot_count, 0);
+    size_t use_clock = 0;
+
+    auto FieldFor = [&](int32_t agent) -> const DistanceField& {
+        size_t slot = 0;
+        for (size_t s = 0; s < slot_count; ++s) {
+            if (field_agent[s] == agent) {
+                field_used[s] = ++use_clock;
+                return fields[s];
+            }
+            if (field_used[s] < field_used[slot]) slot = s;
+        }
+
+        fields[slot].Build(_maze, _maze_hash, agents[agent].goal, _pool);
+        field_agent[slot] = agent;
+        field_used[slot] = ++use_clock;
+        return fields[slot];
+    };
+
+    std::vector<size_t> expanded(agent_count, 0);
+
+    Node root;
+    root.paths.resize(agent_count);
+
+    // The root searches ignore every other agent, so they all share one table that is never written
+    const ReservationTable empty(size_t(_width) * size_t(_height));
+
+    for (size_t first = 0; first < agent_count; first += slot_count) {
+        size_t last = std::min(agent_count, first + slot_count);
+
+        _pool.ParallelFor(first, last, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t slot = i - first;
+                field_agent[slot] = goals[i] < 0 ? -1 : int32_t(i);
+                if (goals[i] < 0) continue;
+
+                fields[slot].Build(_maze, _maze_hash, agents[i].goal, _pool);
+                SearchAgent(starts[i], goals[i], fields[slot], empty, root.paths[i], expanded[i]);
+            }
+        });
+    }
+
+    for (size_t i = 0; i < agent_count; ++i) {
+        root.cost += root.paths[i].GetArrivalTime();
+        result.expanded += expanded[i];
+    }
+
+    // Agents that cannot reach their goal even alone are left out of the conflict search
+    auto FindConflict = [&](const std::vector<AgentPath>& paths, Conflict& conflict) {
+        size_t horizon = 0;
+        for (const AgentPath& path : paths) {
+            horizon = std::max(horizon, path.GetArrivalTime());
+        }
+
+        std::unordered_map<int32_t, int32_t> occupied;
+        for (size_t t = 0; t <= horizon; ++t) {
+            occupied.clear();
+
+            for (size_t i = 0; i < agent_count; ++i) {
+                if (paths[i].Empty()) continue;
+
+                auto [it, inserted] = occupied.try_emplace(paths[i].GetCell(t), int32_t(i));
+                if (!inserted) {
+                    conflict = Conflict{ it->second, int32_t(i), it->first, -1, int32_t(t) };
+                    return true;
+                }
+            }
+
+            for (size_t i = 0; i < agent_count && t < horizon; ++i) {
+                if (paths[i].Empty()) continue;
+
+                int32_t from = paths[i].GetCell(t);
+                int32_t to = paths[i].GetCell(t + 1);
+                if (from == to) continue;
+
+                auto it = occupied.find(to);
+                if (it != occupied.end() && paths[it->second].GetCell(t + 1) == from) {
+                    conflict = Conflict{ int32_t(i), it->second, from, to, int32_t(t) };
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    };
+
+    auto Greater = [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+        return a.first > b.first;
+    };
+
+    std::vector<Node> nodes;
+    std::priority_queue<std::pair<size_t, size_t>, std::vector<std::pair<size_t, size_t>>, decltype(Greater)> open(Greater);
+
+    nodes.push_back(std::move(root));
+    open.push({ nodes[0].cost, 0 });
+
+    ReservationTable constraints(size_t(_width) * size_t(_height));
+
+    while (!open.empty() && result.cbs_nodes < max_nodes) {
+        size_t index = open.top().second;
+        open.pop();
+        ++result.cbs_nodes;
+
+        // Popped nodes are never revisited, so their paths can be moved out
+        Node node = std::move(nodes[index]);
+
+        Conflict conflict;
+        if (!FindConflict(node.paths, conflict)) {
+            result.paths = std::move(node.paths);
+            Finish(result);
+
+            auto end_time = std::chrono::high_resolution_clock::now();
+            result.plan_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+            return result;
+        }
+
+        // Each child forbids the conflict for one of the two agents and replans only that agent
+        for (int side = 0; side < 2; ++side) {
+            Node child;
+            child.constraints = node.constraints;
+            child.paths = node.paths;
+
+            int32_t agent = side == 0 ? conflict.a : conflict.b;
+            if (conflict.to < 0)
+                child.constraints.push_back(Constraint{ agent, conflict.cell, -1, conflict.time });
+            else if (side == 0)
+                child.constraints.push_back(Constraint{ agent, conflict.cell, conflict.to, conflict.time });
+            else
+                child.constraints.push_back(Constraint{ agent, conflict.to, conflict.cell, conflict.time });
+
+            constraints.Clear();
+            for (const Constraint& constraint : child.constraints) {
+                if (constraint.agent != agent) continue;
+
+                if (constraint.to < 0)
+                    constraints.ReserveCell(constraint.cell, constraint.time);
+                else
+                    constraints.ReserveMove(constraint.cell, constraint.to, constraint.time);
+            }
+
+            AgentPath& path = child.paths[agent];
+            size_t previous_cost = path.GetArrivalTime();
+            if (!SearchAgent(starts[agent], goals[agent], FieldFor(agent), constraints, path, result.expanded))
+                continue;
+
+            child.cost = node.cost - previous_cost + path.GetArrivalTime();
+
+            nodes.push_back(std::move(child));
+            open.push({ nodes.back().cost, nodes.size() - 1 });
+        }
+    }
+
+    // Budget exhausted or no conflict-free set exists, settle for prioritised routes
+    size_t cbs_nodes = result.cbs_nodes;
+    size_t cbs_expanded = result.expanded;
+
+    result = PlanPrioritized(agents);
+    result.cbs_nodes = cbs_nodes;
+    result.expanded += cbs_expanded;
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    result.plan_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    return result;
+}
\ No newline at end of file
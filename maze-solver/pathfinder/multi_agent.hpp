@@ -0,0 +1,117 @@
+#ifndef MULTI_AGENT_HPP
+#define MULTI_AGENT_HPP
+
+#include "../path/path.hpp"
+
+#include <imgui.h>
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+class DistanceField;
+
+// Cells an agent occupies over time: cells[t] is its cell at timestep t and a
+// repeated cell is a wait. An agent stays on its last cell after arriving.
+struct AgentPath {
+    std::vector<int32_t> cells; // flat, y * width + x
+
+    bool Empty() const;
+    size_t GetArrivalTime() const;
+    int32_t GetCell(size_t time) const; // clamps to the goal after arrival
+    CompactPath ToCompactPath(int width) const; // drops the waits
+};
+
+// Space-time occupancy checked by the low-level search. Prioritised planning fills
+// it with the routes of higher-priority agents, Conflict-Based Search with the
+// constraints of a single agent. The dense per-cell arrays are only allocated by
+// the first reservation, so an empty table costs nothing on a large grid.
+class ReservationTable {
+public:
+    explicit ReservationTable(size_t cell_count);
+
+    void Clear();
+    void ReserveCell(int32_t cell, int32_t time);
+    void ReserveMove(int32_t from, int32_t to, int32_t time); // blocks from -> to between time and time + 1
+    void ReserveForever(int32_t cell, int32_t time);          // blocks the cell from time onwards
+    void ReservePath(const AgentPath& path);
+
+    bool IsCellBlocked(int32_t cell, int32_t time) const;
+    bool IsMoveBlocked(int32_t from, int32_t to, int32_t time) const;
+    int32_t GetLastReservedTime(int32_t cell) const; // -1 when the cell is never reserved
+    int32_t GetHorizon() const;                      // last timestep with a temporary reservation
+
+private:
+    static uint64_t CellKey(int32_t cell, int32_t time);
+    static uint64_t MoveKey(int32_t from, int32_t to, int32_t time);
+    void Touch(int32_t cell);
+
+    size_t _cell_count;
+    std::unordered_set<uint64_t> _cells;
+    std::unordered_set<uint64_t> _moves;
+
+    // Dense per-cell bounds let most lookups skip the hash sets entirely
+    std::vector<int32_t> _forever;        // first timestep of a permanent reservation
+    std::vector<int32_t> _last_reserved;  // last timestep the cell is reserved
+    std::vector<int32_t> _last_move;      // last timestep a move out of the cell is reserved
+    std::vector<int32_t> _touched;        // cells to reset on Clear
+    int32_t _horizon;
+};
+
+// Collision-free routes for several agents on one grid. Every agent moves or waits
+// one step per timestep; two agents may neither share a cell nor swap cells.
+class MultiAgentPlanner {
+public:
+    enum class Method {
+        Prioritized = 0,
+        ConflictBased
+    };
+
+    struct Agent {
+        ImVec2 start;
+        ImVec2 goal;
+    };
+
+    struct Result {
+        std::vector<AgentPath> paths; // one per agent, empty when it could not be routed
+        Method method = Method::Prioritized;
+        size_t failed = 0;
+        size_t makespan = 0;
+        size_t sum_of_costs = 0;
+        size_t expanded = 0;
+        size_t cbs_nodes = 0;
+        double plan_time = 0.0;
+    };
+
+    // Conflict-Based Search is exponential in the number of conflicts, larger fleets use prioritised planning
+    static constexpr size_t cbs_agent_limit = 12;
+    static constexpr size_t cbs_node_limit = 2000;
+
+    // Heuristic fields cost 4 bytes per cell; at most this much of them stays resident
+    static constexpr size_t field_budget_bytes = size_t(512) << 20;
+
+    MultiAgentPlanner(const std::vector<std::vector<int>>& maze, ThreadPool& pool);
+
+    Result Plan(const std::vector<Agent>& agents, Method method);
+
+    // Agents are planned in order, each avoiding the routes of the ones before it
+    Result PlanPrioritized(const std::vector<Agent>& agents);
+
+    // Optimal for sum of costs; falls back to prioritised planning when the node budget runs out
+    Result PlanConflictBased(const std::vector<Agent>& agents, size_t max_nodes = cbs_node_limit);
+
+private:
+    bool ToCell(ImVec2 pos, int32_t& cell) const;
+    size_t GetFieldBudget() const; // fields that fit in field_budget_bytes, at least one
+    bool SearchAgent(int32_t start, int32_t goal, const DistanceField& heuristic, const ReservationTable& reservations, AgentPath& path, size_t& expanded) const;
+    void Finish(Result& result) const;
+
+    const std::vector<std::vector<int>>& _maze;
+    ThreadPool& _pool;
+    int _width;
+    int _height;
+    uint64_t _maze_hash;
+};
+
+#endif // MULTI_AGENT_HPP
\ No newline at end of file
@@ -1,138 +1,267 @@
 #include "pathfinder.hpp"
+#include "clearance.hpp"
+#include "../profiler/profiler.hpp"
 
-#include <queue>
-#include <limits>
 #include <algorithm>
 
-Pathfinder::Node::Node(int x, int y, int distance)
-    : x(x), y(y), distance(distance) {}
+namespace {
+    // Clearance map as a search grid; walls have clearance 0 and never pass
+    template <int Scale>
+    struct ClearanceGridView {
+        const float* clearance;
+        int width;
+        int height;
+        float min_clearance;
+        float wall_penalty;
+
+        bool Passable(int x, int y) const {
+            float value = clearance[size_t(y) * width + x];
+            return value > 0.0f && value >= min_clearance;
+        }
 
-bool Pathfinder::Node::operator>(const Pathfinder::Node& other) const {
-    return distance > other.distance;
+        int64_t StepCost(int x, int y) const {
+            float value = clearance[size_t(y) * width + x];
+            return Scale + int64_t(Scale * wall_penalty / value);
+        }
+    };
 }
 
-std::vector<ImVec2> Pathfinder::SolveMazeWithDijkstra(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos) {
-    int rows = maze.size();
-    int cols = maze[0].size();
+template <typename Kernel>
+CompactPath Pathfinder::Solve(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos) {
+    if (maze.empty() || maze[0].empty())
+        return {};
 
-    std::vector<std::vector<int>> distance(rows, std::vector<int>(cols, std::numeric_limits<int>::max()));
-    std::vector<std::vector<ImVec2>> previous(rows, std::vector<ImVec2>(cols, ImVec2(-1, -1)));
-    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> priority_queue;
+    ProfileZone zone("Solve");
 
-    int start_x = static_cast<int>(start_pos.x);
-    int start_y = static_cast<int>(start_pos.y);
-    int end_x = static_cast<int>(end_pos.x);
-    int end_y = static_cast<int>(end_pos.y);
+    int rows = static_cast<int>(maze.size());
+    int cols = static_cast<int>(maze[0].size());
 
-    priority_queue.push(Node(start_x, start_y, 0));
-    distance[start_y][start_x] = 0;
+    int sx = int(start_pos.x), sy = int(start_pos.y);
+    int ex = int(end_pos.x), ey = int(end_pos.y);
 
-    const int dx[] = { 0, 1, 0, -1 };
-    const int dy[] = { -1, 0, 1, 0 };
+    if (sx < 0 || sy < 0 || sx >= cols || sy >= rows || ex < 0 || ey < 0 || ex >= cols || ey >= rows)
+        return {};
 
-    while (!priority_queue.empty()) {
-        Node current = priority_queue.top();
-        priority_queue.pop();
+    SearchBuffers<int32_t>& buffers = GetThreadBuffers<int32_t>();
+    if (!Kernel::Run(MazeGridView{ maze, cols, rows }, sx, sy, ex, ey, buffers))
+        return {}; // No path found
 
-        if (current.x == end_x && current.y == end_y) {
-            std::vector<ImVec2> path;
-            ImVec2 position = ImVec2(end_x, end_y);
+    return TracePath(buffers, cols, ey * cols + ex);
+}
 
-            while (position.x != -1 && position.y != -1) {
-                path.push_back(position);
-                position = previous[static_cast<int>(position.y)][static_cast<int>(position.x)];
-            }
+// One workspace per thread and cost type shared by every kernel, reused across solves so repeat queries skip the allocation
+template <typename Cost>
+SearchBuffers<Cost>& Pathfinder::GetThreadBuffers() {
+    thread_local SearchBuffers<Cost> buffers;
+    return buffers;
+}
 
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
+template <typename Cost>
+CompactPath Pathfinder::TracePath(const SearchBuffers<Cost>& buffers, int width, int32_t end_index) {
+    // First pass finds the start and length, second pass fills the moves back to front
+    size_t move_count = 0;
+    int32_t start_index = end_index;
+    while (buffers.GetParent(start_index) != -1) {
+        start_index = buffers.GetParent(start_index);
+        ++move_count;
+    }
 
-        for (int i = 0; i < 4; ++i) {
-            int next_x = current.x + dx[i];
-            int next_y = current.y + dy[i];
+    CompactPath path(start_index % width, start_index / width, move_count);
 
-            if (next_x >= 0 && next_y >= 0 && next_x < cols && next_y < rows && maze[next_y][next_x] == 1) {
-                int new_distance = distance[current.y][current.x] + 1;
+    int32_t index = end_index;
+    for (size_t i = move_count; i > 0; --i) {
+        int32_t from = buffers.GetParent(index);
 
-                if (new_distance < distance[next_y][next_x]) {
-                    distance[next_y][next_x] = new_distance;
-                    priority_queue.push(Node(next_x, next_y, new_distance));
-                    previous[next_y][next_x] = ImVec2(current.x, current.y);
-                }
-            }
-        }
+        CompactPath::Direction direction;
+        if (index == from + width)
+            direction = CompactPath::Direction::Down;
+        else if (index == from - width)
+            direction = CompactPath::Direction::Up;
+        else if (index == from + 1)
+            direction = CompactPath::Direction::Right;
+        else
+            direction = CompactPath::Direction::Left;
+
+        path.SetMove(i - 1, direction);
+        index = from;
     }
 
-    return {}; // No path found
+    return path;
 }
 
-Pathfinder::ANode::ANode(int x, int y, float g, float f)
-    : x(x), y(y), g(g), f(f) {
+CompactPath Pathfinder::SolveMazeWithDijkstra(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos) {
+    return Solve<DijkstraKernel>(maze, start_pos, end_pos);
 }
 
-bool Pathfinder::ANode::operator>(ANode const& o) const {
-    return f > o.f;
+CompactPath Pathfinder::SolveMazeWithAStar(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos) {
+    return Solve<AStarKernel>(maze, start_pos, end_pos);
 }
 
-std::vector<ImVec2> Pathfinder::SolveMazeWithAStar(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos)
-{
-    int rows = maze.size();
-    int cols = maze[0].size();
+CompactPath Pathfinder::SolveWithClearance(const ClearanceMap& clearance, ImVec2 start_pos, ImVec2 end_pos, float min_clearance, float wall_penalty) {
+    int cols = clearance.GetWidth();
+    int rows = clearance.GetHeight();
 
     int sx = int(start_pos.x), sy = int(start_pos.y);
     int ex = int(end_pos.x), ey = int(end_pos.y);
 
-    std::vector<std::vector<float>> g(rows, std::vector<float>(cols, std::numeric_limits<float>::infinity()));
-    std::vector<std::vector<ImVec2>> prev(rows, std::vector<ImVec2>(cols, ImVec2(-1, -1)));
+    if (cols == 0 || sx < 0 || sy < 0 || sx >= cols || sy >= rows || ex < 0 || ey < 0 || ex >= cols || ey >= rows)
+        return {};
 
-    auto heuristic = [&](int x, int y) {
-        return float(std::abs(x - ex) + std::abs(y - ey));
-    };
+    ProfileZone zone("Solve");
 
-    std::priority_queue<ANode, std::vector<ANode>, std::greater<ANode>> open_set;
+    // Typed-in values can exceed the GUI slider range; the clamp keeps every step cost finite
+    ClearanceGridView<clearance_cost_scale> view{ clearance.GetData(), cols, rows, min_clearance, std::clamp(wall_penalty, 0.0f, max_wall_penalty) };
 
-    g[sy][sx] = 0.0f;
-    open_set.emplace(sx, sy, 0.0f, heuristic(sx, sy));
+    SearchBuffers<int64_t>& buffers = GetThreadBuffers<int64_t>();
+    if (!ClearanceKernel::Run(view, sx, sy, ex, ey, buffers))
+        return {};
 
-    int dx[4] = { 0, 1, 0, -1 };
-    int dy[4] = { -1, 0, 1, 0 };
+    return TracePath(buffers, cols, ey * cols + ex);
+}
 
-    while (!open_set.empty()) {
-        ANode cur = open_set.top(); open_set.pop();
+std::vector<int32_t> Pathfinder::LabelComponents(const std::vector<std::vector<int>>& maze) {
+    if (maze.empty() || maze[0].empty())
+        return {};
 
-        if (cur.x == ex && cur.y == ey) {
-            std::vector<ImVec2> path;
-            ImVec2 p{ float(ex), float(ey) };
+    int rows = static_cast<int>(maze.size());
+    int cols = static_cast<int>(maze[0].size());
 
-            while (p.x >= 0 && p.y >= 0) {
-                path.push_back(p);
-                p = prev[int(p.y)][int(p.x)];
-            }
+    std::vector<int32_t> components(size_t(rows) * size_t(cols), 0);
+    std::vector<int32_t> stack;
+    int32_t next_label = 0;
 
-            std::reverse(path.begin(), path.end());
-            return path;
-        }
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            int32_t seed = y * cols + x;
+            if (maze[y][x] != 1 || components[seed] != 0)
+                continue;
 
-        for (int i = 0; i < 4; ++i) {
-            int nx = cur.x + dx[i];
-            int ny = cur.y + dy[i];
+            ++next_label;
+            components[seed] = next_label;
+            stack.push_back(seed);
 
-            if (nx < 0 || ny < 0 || nx >= cols || ny >= rows)
-                continue;
+            while (!stack.empty()) {
+                int32_t index = stack.back();
+                stack.pop_back();
 
-            if (maze[ny][nx] == 0)
-                continue;
+                int cx = index % cols;
+                int cy = index / cols;
 
-            float tentative_g = cur.g + 1.0f;
-            if (tentative_g < g[ny][nx]) {
-                g[ny][nx] = tentative_g;
-                prev[ny][nx] = ImVec2(float(cur.x), float(cur.y));
+                for (int i = 0; i < FourConnected::count; ++i) {
+                    int nx = cx + FourConnected::dx[i];
+                    int ny = cy + FourConnected::dy[i];
 
-                float f = tentative_g + heuristic(nx, ny);
-                open_set.emplace(nx, ny, tentative_g, f);
+                    if (unsigned(nx) >= unsigned(cols) || unsigned(ny) >= unsigned(rows))
+                        continue;
+
+                    int32_t next = ny * cols + nx;
+                    if (maze[ny][nx] == 1 && components[next] == 0) {
+                        components[next] = next_label;
+                        stack.push_back(next);
+                    }
+                }
             }
         }
     }
 
-    return {}; // no path
+    return components;
+}
+
+std::vector<size_t> Pathfinder::MeasureComponents(const std::vector<int32_t>& components) {
+    std::vector<size_t> sizes;
+    for (int32_t label : components) {
+        if (label < 0) continue;
+        if (size_t(label) >= sizes.size()) sizes.resize(size_t(label) + 1, 0);
+        ++sizes[label];
+    }
+    return sizes;
+}
+
+bool Pathfinder::CanReach(const std::vector<int32_t>& components, int width, ImVec2 start_pos, ImVec2 end_pos) {
+    if (components.empty() || width <= 0)
+        return false;
+
+    int height = static_cast<int>(components.size() / width);
+    int sx = int(start_pos.x), sy = int(start_pos.y);
+    int ex = int(end_pos.x), ey = int(end_pos.y);
+
+    if (sx < 0 || sy < 0 || sx >= width || sy >= height || ex < 0 || ey < 0 || ex >= width || ey >= height)
+        return false;
+
+    if (sx == ex && sy == ey)
+        return true;
+
+    int32_t end_label = components[ey * width + ex];
+    if (end_label == 0)
+        return false;
+
+    int32_t start_label = components[sy * width + sx];
+    if (start_label != 0)
+        return start_label == end_label;
+
+    for (int i = 0; i < FourConnected::count; ++i) {
+        int nx = sx + FourConnected::dx[i];
+        int ny = sy + FourConnected::dy[i];
+
+        if (unsigned(nx) < unsigned(width) && unsigned(ny) < unsigned(height) && components[ny * width + nx] == end_label)
+            return true;
+    }
+
+    return false;
+}
+
+bool Pathfinder::FindBorderOpenings(const std::vector<std::vector<int>>& maze, ImVec2 top_left, ImVec2 bottom_right, ImVec2& start_pos, ImVec2& end_pos) {
+    if (maze.empty() || maze[0].empty())
+        return false;
+
+    int rows = static_cast<int>(maze.size());
+    int cols = static_cast<int>(maze[0].size());
+
+    int min_x = std::max(0, int(top_left.x)), min_y = std::max(0, int(top_left.y));
+    int max_x = std::min(cols - 1, int(bottom_right.x)), max_y = std::min(rows - 1, int(bottom_right.y));
+
+    if (min_x >= max_x || min_y >= max_y)
+        return false;
+
+    // Walk the perimeter clockwise from the top-left corner
+    std::vector<ImVec2> perimeter;
+    for (int x = min_x; x < max_x; ++x) perimeter.emplace_back(float(x), float(min_y));
+    for (int y = min_y; y < max_y; ++y) perimeter.emplace_back(float(max_x), float(y));
+    for (int x = max_x; x > min_x; --x) perimeter.emplace_back(float(x), float(max_y));
+    for (int y = max_y; y > min_y; --y) perimeter.emplace_back(float(min_x), float(y));
+
+    auto IsOpen = [&](size_t i) {
+        const ImVec2& p = perimeter[i % perimeter.size()];
+        return maze[int(p.y)][int(p.x)] == 1;
+    };
+
+    // Begin at a wall so no gap is split across the wrap-around
+    size_t offset = 0;
+    while (offset < perimeter.size() && IsOpen(offset)) ++offset;
+    if (offset == perimeter.size())
+        return false;
+
+    struct Gap { size_t first, length; };
+    std::vector<Gap> gaps;
+
+    for (size_t i = 0; i < perimeter.size(); ++i) {
+        if (!IsOpen(offset + i))
+            continue;
+
+        if (!gaps.empty() && gaps.back().first + gaps.back().length == offset + i)
+            ++gaps.back().length;
+        else
+            gaps.push_back({ offset + i, 1 });
+    }
+
+    if (gaps.size() < 2)
+        return false;
+
+    std::stable_sort(gaps.begin(), gaps.end(), [](const Gap& a, const Gap& b) { return a.length > b.length; });
+    if (gaps[0].first > gaps[1].first)
+        std::swap(gaps[0], gaps[1]);
+
+    start_pos = perimeter[(gaps[0].first + gaps[0].length / 2) % perimeter.size()];
+    end_pos = perimeter[(gaps[1].first + gaps[1].length / 2) % perimeter.size()];
+    return true;
 }
\ No newline at end of file
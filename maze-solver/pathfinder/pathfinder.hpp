@@ -2,27 +2,55 @@
 #define PATHFINDER_HPP
 
 #include <vector>
+#include <cstdint>
 #include <imgui.h>
 
+#include "search.hpp"
+#include "../path/path.hpp"
+
+class ClearanceMap;
+
 class Pathfinder {
 public:
-    static std::vector<ImVec2> SolveMazeWithDijkstra(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos);
+    static CompactPath SolveMazeWithDijkstra(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos);
+
+    static CompactPath SolveMazeWithAStar(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos);
+
+    // A* that treats cells with less than min_clearance as walls and charges every step
+    // 1 + wall_penalty / clearance, so routes keep to the middle of wide corridors
+    static CompactPath SolveWithClearance(const ClearanceMap& clearance, ImVec2 start_pos, ImVec2 end_pos, float min_clearance, float wall_penalty);
+
+    // Labels every walkable cell with a 1-based connected component id, walls get 0
+    static std::vector<int32_t> LabelComponents(const std::vector<std::vector<int>>& maze);
+
+    // Cell count of every LabelComponents label, indexed by label; entry 0 counts the walls
+    static std::vector<size_t> MeasureComponents(const std::vector<int32_t>& components);
 
-    static std::vector<ImVec2> SolveMazeWithAStar(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos);
+    // Constant-time reachability test against LabelComponents output; a start on a wall
+    // pixel counts as connected to the components of its walkable neighbours
+    static bool CanReach(const std::vector<int32_t>& components, int width, ImVec2 start_pos, ImVec2 end_pos);
+
+    // Finds the two widest gaps in the outer wall of the maze bounding box and returns their centres
+    static bool FindBorderOpenings(const std::vector<std::vector<int>>& maze, ImVec2 top_left, ImVec2 bottom_right, ImVec2& start_pos, ImVec2& end_pos);
 
 private:
-    struct Node {
-        int x, y, distance;
-        Node(int x, int y, int distance);
-        bool operator>(const Node& other) const;
-    };
-
-    struct ANode {
-        int x, y;
-        float g, f;
-        ANode(int x, int y, float g, float f);
-        bool operator>(ANode const& o) const;
-    };
+    using DijkstraKernel = SearchKernel<ZeroHeuristic, FourConnected, int32_t, BinaryHeapQueue, StopAtGoal>;
+    using AStarKernel = SearchKernel<ManhattanHeuristic, FourConnected, int32_t, BinaryHeapQueue, StopAtGoal>;
+
+    // Step costs are fixed-point so fractional wall penalties survive the integer queue.
+    // A penalised step can cost thousands of times a plain one, so the sums are 64-bit.
+    static constexpr int clearance_cost_scale = 16;
+    static constexpr float max_wall_penalty = 1e6f;
+    using ClearanceKernel = SearchKernel<ScaledManhattanHeuristic<clearance_cost_scale>, FourConnected, int64_t, BinaryHeapQueue, StopAtGoal>;
+
+    template <typename Kernel>
+    static CompactPath Solve(const std::vector<std::vector<int>>& maze, ImVec2 start_pos, ImVec2 end_pos);
+
+    template <typename Cost>
+    static SearchBuffers<Cost>& GetThreadBuffers();
+
+    template <typename Cost>
+    static CompactPath TracePath(const SearchBuffers<Cost>& buffers, int width, int32_t end_index);
 };
 
 #endif // PATHFINDER_HPP
\ No newline at end of file
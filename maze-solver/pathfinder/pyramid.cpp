@@ -0,0 +1,339 @@
+#include "pyramid.hpp"
+#include "search.hpp"
+#include "../threading/thread_pool.hpp"
+#include "../profiler/profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+namespace {
+    using CorridorKernel = SearchKernel<ManhattanHeuristic, FourConnected, int32_t, BinaryHeapQueue, StopAtGoal>;
+
+    // How far a coarse endpoint may move to find a cell that is walkable at that level
+    constexpr int snap_radius = 2;
+
+    // One level of the pyramid, optionally restricted to a corridor bitmask
+    struct LevelGridView {
+        const uint8_t* walkable;
+        const uint64_t* corridor;
+        int width;
+        int height;
+
+        bool Passable(int x, int y) const {
+            size_t index = size_t(y) * width + x;
+            return walkable[index] && (!corridor || (corridor[index >> 6] >> (index & 63)) & 1);
+        }
+
+        int StepCost(int, int) const {
+            return 1;
+        }
+    };
+
+    // Bits that were set are remembered so the next solve clears only those words
+    struct Corridor {
+        std::vector<uint64_t> bits;
+        std::vector<size_t> words;
+        size_t count = 0;
+
+        void Reset(size_t cell_count) {
+            if (bits.size() != (cell_count + 63) / 64) {
+                bits.assign((cell_count + 63) / 64, 0);
+            }
+            else {
+                for (size_t word : words) bits[word] = 0;
+            }
+            words.clear();
+            count = 0;
+        }
+
+        void Mark(size_t index) {
+            uint64_t& word = bits[index >> 6];
+            uint64_t bit = uint64_t(1) << (index & 63);
+
+            if (!(word & bit)) {
+                if (!word) words.push_back(index >> 6);
+                word |= bit;
+                ++count;
+            }
+        }
+    };
+
+    CompactPath ToCompactPath(const std::vector<int32_t>& cells, int width) {
+        if (cells.empty()) return {};
+
+        CompactPath path(cells[0] % width, cells[0] / width, cells.size() - 1);
+
+        for (size_t i = 1; i < cells.size(); ++i) {
+            int32_t step = cells[i] - cells[i - 1];
+
+            CompactPath::Direction direction;
+            if (step == width)
+                direction = CompactPath::Direction::Down;
+            else if (step == -width)
+                direction = CompactPath::Direction::Up;
+            else if (step == 1)
+                direction = CompactPath::Direction::Right;
+            else
+                direction = CompactPath::Direction::Left;
+
+            path.SetMove(i - 1, direction);
+        }
+
+        return path;
+    }
+}
+
+MazePyramid::MazePyramid() {
+    _valid = false;
+    _maze_hash = 0;
+    _build_time = 0.0;
+}
+
+void MazePyramid::Build(const std::vector<std::vector<int>>& maze, uint64_t maze_hash, ThreadPool& pool) {
+    ProfileZone zone("Pyramid Build");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Invalidate();
+    if (maze.empty() || maze[0].empty()) return;
+
+    _maze_hash = maze_hash;
+    _levels.resize(1);
+
+    Level& base = _levels[0];
+    base.height = static_cast<int>(maze.size());
+    base.width = static_cast<int>(maze[0].size());
+    base.walkable.resize(size_t(base.width) * size_t(base.height));
+
+    pool.ParallelFor(0, size_t(base.height), [&](size_t begin, size_t end) {
+        for (size_t y = begin; y < end; ++y) {
+            for (int x = 0; x < base.width; ++x) {
+                base.walkable[y * base.width + x] = maze[y][x] == 1;
+            }
+        }
+    });
+
+    // Each level reads only the one below it, so the rows of a level are independent
+    while (int(_levels.size()) < max_levels) {
+        const Level& fine = _levels.back();
+        if (fine.width / 2 < min_level_size || fine.height / 2 < min_level_size)
+            break;
+
+        Level coarse;
+        coarse.width = (fine.width + 1) / 2;
+        coarse.height = (fine.height + 1) / 2;
+        coarse.walkable.resize(size_t(coarse.width) * size_t(coarse.height));
+
+        pool.ParallelFor(0, size_t(coarse.height), [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; ++y) {
+                int fy = int(y) * 2;
+                int fy_last = std::min(fy + 1, fine.height - 1);
+
+                for (int x = 0; x < coarse.width; ++x) {
+                    int fx = x * 2;
+                    int fx_last = std::min(fx + 1, fine.width - 1);
+
+                    const uint8_t* top = &fine.walkable[size_t(fy) * fine.width];
+                    const uint8_t* bottom = &fine.walkable[size_t(fy_last) * fine.width];
+
+                    coarse.walkable[y * coarse.width + x] = top[fx] & top[fx_last] & bottom[fx] & bottom[fx_last];
+                }
+            }
+        });
+
+        _levels.push_back(std::move(coarse));
+    }
+
+    pool.ParallelFor(0, _levels.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            Level& level = _levels[i];
+            size_t open = std::count(level.walkable.begin(), level.walkable.end(), uint8_t(1));
+            level.open_fraction = double(open) / double(level.walkable.size());
+        }
+    });
+
+    _valid = true;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    _build_time = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void MazePyramid::Invalidate() {
+    _valid = false;
+    _levels.clear();
+}
+
+bool MazePyramid::IsValidFor(uint64_t maze_hash) const {
+    return _valid && _maze_hash == maze_hash;
+}
+
+size_t MazePyramid::GetLevelCount() const {
+    return _levels.size();
+}
+
+const MazePyramid::Level& MazePyramid::GetLevel(size_t index) const {
+    return _levels[index];
+}
+
+double MazePyramid::GetBuildTime() const {
+    return _build_time;
+}
+
+// Moves (x, y) to the closest walkable cell of the level within snap_radius
+bool MazePyramid::Snap(int level, int& x, int& y) const {
+    const Level& grid = _levels[level];
+
+    int best_x = -1, best_y = -1;
+    int best_distance = snap_radius * 2 + 1;
+
+    for (int dy = -snap_radius; dy <= snap_radius; ++dy) {
+        for (int dx = -snap_radius; dx <= snap_radius; ++dx) {
+            int nx = x + dx, ny = y + dy;
+            int distance = std::abs(dx) + std::abs(dy);
+
+            if (distance >= best_distance || unsigned(nx) >= unsigned(grid.width) || unsigned(ny) >= unsigned(grid.height))
+                continue;
+
+            if (grid.walkable[size_t(ny) * grid.width + nx]) {
+                best_x = nx;
+                best_y = ny;
+                best_distance = distance;
+            }
+        }
+    }
+
+    if (best_x < 0) return false;
+
+    x = best_x;
+    y = best_y;
+    return true;
+}
+
+bool MazePyramid::Search(int level, int sx, int sy, int ex, int ey, const std::vector<uint64_t>* corridor, std::vector<int32_t>& cells) const {
+    const Level& grid = _levels[level];
+
+    // One workspace per level and thread; every level has its own size, so sharing one would reallocate
+    thread_local std::vector<SearchBuffers<int32_t>> buffers;
+    if (buffers.size() < _levels.size()) buffers.resize(_levels.size());
+
+    LevelGridView view{ grid.walkable.data(), corridor ? corridor->data() : nullptr, grid.width, grid.height };
+
+    cells.clear();
+    if (!CorridorKernel::Run(view, sx, sy, ex, ey, buffers[level]))
+        return false;
+
+    for (int32_t index = ey * grid.width + ex; index != -1; index = buffers[level].GetParent(index)) {
+        cells.push_back(index);
+    }
+    std::reverse(cells.begin(), cells.end());
+
+    return true;
+}
+
+MazePyramid::Result MazePyramid::Solve(ImVec2 start_pos, ImVec2 end_pos, int corridor_radius, bool measure_gap) const {
+    ProfileZone zone("Coarse-to-Fine Solve");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Result result;
+    if (!_valid) return result;
+
+    const Level& base = _levels[0];
+    int sx = int(start_pos.x), sy = int(start_pos.y);
+    int ex = int(end_pos.x), ey = int(end_pos.y);
+
+    if (sx < 0 || sy < 0 || sx >= base.width || sy >= base.height || ex < 0 || ey < 0 || ex >= base.width || ey >= base.height)
+        return result;
+
+    std::vector<int32_t> route;
+    int level = int(_levels.size()) - 1;
+
+    // Coarse levels are tiny, so trying them from the top down costs little
+    for (; level > 0; --level) {
+        if (_levels[level].open_fraction < _levels[0].open_fraction * min_open_ratio)
+            continue;
+
+        int lsx = sx >> level, lsy = sy >> level;
+        int lex = ex >> level, ley = ey >> level;
+
+        if (Snap(level, lsx, lsy) && Snap(level, lex, ley) && Search(level, lsx, lsy, lex, ley, nullptr, route))
+            break;
+    }
+
+    result.coarse_level = level;
+
+    thread_local Corridor corridor;
+
+    for (int fine = level - 1; fine >= 0; --fine) {
+        const Level& coarse_grid = _levels[fine + 1];
+        const Level& fine_grid = _levels[fine];
+
+        corridor.Reset(size_t(fine_grid.width) * size_t(fine_grid.height));
+
+        auto MarkBlock = [&](int cx, int cy) {
+            for (int y = cy * 2; y <= cy * 2 + 1 && y < fine_grid.height; ++y) {
+                for (int x = cx * 2; x <= cx * 2 + 1 && x < fine_grid.width; ++x) {
+                    corridor.Mark(size_t(y) * fine_grid.width + x);
+                }
+            }
+        };
+
+        // The children of every coarse cell within corridor_radius of the route
+        for (int32_t cell : route) {
+            int cx = cell % coarse_grid.width;
+            int cy = cell / coarse_grid.width;
+
+            for (int dy = -corridor_radius; dy <= corridor_radius; ++dy) {
+                for (int dx = -corridor_radius; dx <= corridor_radius; ++dx) {
+                    int nx = cx + dx, ny = cy + dy;
+                    if (unsigned(nx) < unsigned(coarse_grid.width) && unsigned(ny) < unsigned(coarse_grid.height)) {
+                        MarkBlock(nx, ny);
+                    }
+                }
+            }
+        }
+
+        // Endpoints were snapped on the coarser level, so connect the true ones to the route
+        int lsx = sx >> fine, lsy = sy >> fine;
+        int lex = ex >> fine, ley = ey >> fine;
+        int endpoint_radius = 2 * (snap_radius + corridor_radius);
+
+        for (auto [px, py] : { std::pair{ lsx, lsy }, std::pair{ lex, ley } }) {
+            for (int y = std::max(0, py - endpoint_radius); y <= std::min(fine_grid.height - 1, py + endpoint_radius); ++y) {
+                for (int x = std::max(0, px - endpoint_radius); x <= std::min(fine_grid.width - 1, px + endpoint_radius); ++x) {
+                    corridor.Mark(size_t(y) * fine_grid.width + x);
+                }
+            }
+        }
+
+        bool snapped = fine == 0 || (Snap(fine, lsx, lsy) && Snap(fine, lex, ley));
+        if (!snapped || !Search(fine, lsx, lsy, lex, ley, &corridor.bits, route)) {
+            result.fell_back = true;
+            break;
+        }
+
+        if (fine == 0) {
+            result.corridor_cells = corridor.count;
+        }
+    }
+
+    if (level == 0 || result.fell_back) {
+        Search(0, sx, sy, ex, ey, nullptr, route);
+        result.corridor_cells = size_t(base.width) * size_t(base.height);
+    }
+
+    result.path = ToCompactPath(route, base.width);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    result.solve_time = std::chrono::duration<double, std::milli>(end - start).count();
+
+    if (measure_gap && !result.path.Empty()) {
+        std::vector<int32_t> optimal;
+        Search(0, sx, sy, ex, ey, nullptr, optimal);
+
+        result.optimal_length = optimal.size();
+        result.gap_measured = true;
+        result.full_solve_time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - end).count();
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#ifndef PYRAMID_HPP
+#define PYRAMID_HPP
+
+#include "../path/path.hpp"
+
+#include <imgui.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class ThreadPool;
+
+// Mipmap-style stack of walkability grids. Level 0 is the full grid and every level
+// above halves both sides. A coarse cell is walkable only if all of its fine cells
+// are, so any coarse route is also open at full resolution.
+class MazePyramid {
+public:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> walkable; // flat, y * width + x
+        double open_fraction = 0.0;
+    };
+
+    struct Result {
+        CompactPath path;
+        int coarse_level = 0;      // level the route was first found on, 0 for a plain full search
+        bool fell_back = false;    // a corridor was blocked and the full search ran instead
+        size_t corridor_cells = 0; // cells open to the full-resolution search
+        size_t optimal_length = 0; // only set when the gap was measured
+        bool gap_measured = false;
+        double solve_time = 0.0;
+        double full_solve_time = 0.0;
+    };
+
+    static constexpr int max_levels = 12;
+    static constexpr int min_level_size = 16;
+
+    // Levels keeping less than this share of level 0's open area have closed off
+    // passages and would steer the route around them
+    static constexpr double min_open_ratio = 0.85;
+
+    MazePyramid();
+
+    void Build(const std::vector<std::vector<int>>& maze, uint64_t maze_hash, ThreadPool& pool);
+    void Invalidate();
+
+    bool IsValidFor(uint64_t maze_hash) const;
+    size_t GetLevelCount() const;
+    const Level& GetLevel(size_t index) const;
+    double GetBuildTime() const;
+
+    // Routes on the coarsest level that connects the endpoints, then refines inside a corridor
+    // of corridor_radius cells around it on every finer level. measure_gap also runs the
+    // full-resolution search to report how far the result is from optimal.
+    Result Solve(ImVec2 start_pos, ImVec2 end_pos, int corridor_radius = 2, bool measure_gap = false) const;
+
+private:
+    bool Snap(int level, int& x, int& y) const;
+    bool Search(int level, int sx, int sy, int ex, int ey, const std::vector<uint64_t>* corridor, std::vector<int32_t>& cells) const;
+
+    bool _valid;
+    uint64_t _maze_hash;
+    double _build_time;
+    std::vector<Level> _levels;
+};
+
+#endif // PYRAMID_HPP
\ No newline at end of file
@@ -0,0 +1,201 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+
+// Policies for SearchKernel. Each one is a compile-time parameter so every
+// instantiation gets its own fully inlined inner loop.
+
+struct ZeroHeuristic {
+    template <typename Cost>
+    static Cost Estimate(int, int, int, int) {
+        return Cost(0);
+    }
+};
+
+struct ManhattanHeuristic {
+    template <typename Cost>
+    static Cost Estimate(int x, int y, int goal_x, int goal_y) {
+        return Cost(std::abs(x - goal_x) + std::abs(y - goal_y));
+    }
+};
+
+// Manhattan distance in fixed-point cost units, for grids whose cheapest step costs Scale
+template <int Scale>
+struct ScaledManhattanHeuristic {
+    template <typename Cost>
+    static Cost Estimate(int x, int y, int goal_x, int goal_y) {
+        return Cost(Scale * (std::abs(x - goal_x) + std::abs(y - goal_y)));
+    }
+};
+
+struct FourConnected {
+    static constexpr int count = 4;
+    static constexpr int dx[count] = { 0, 1, 0, -1 };
+    static constexpr int dy[count] = { -1, 0, 1, 0 };
+};
+
+struct StopAtGoal {
+    static constexpr bool stop_at_goal = true;
+};
+
+struct ExploreAll {
+    static constexpr bool stop_at_goal = false;
+};
+
+template <typename Cost>
+struct SearchNode {
+    int32_t index;
+    Cost priority;
+
+    bool operator>(const SearchNode& other) const {
+        return priority > other.priority;
+    }
+};
+
+template <typename Cost>
+class BinaryHeapQueue {
+public:
+    bool Empty() const {
+        return _heap.empty();
+    }
+
+    void Push(int32_t index, Cost priority) {
+        _heap.push(SearchNode<Cost>{ index, priority });
+    }
+
+    SearchNode<Cost> Pop() {
+        SearchNode<Cost> top = _heap.top();
+        _heap.pop();
+        return top;
+    }
+
+private:
+    std::priority_queue<SearchNode<Cost>, std::vector<SearchNode<Cost>>, std::greater<SearchNode<Cost>>> _heap;
+};
+
+// Read-only view of the binary grid produced by Image::ConvertToMazeGrid
+struct MazeGridView {
+    const std::vector<std::vector<int>>& maze;
+    int width;
+    int height;
+
+    bool Passable(int x, int y) const {
+        return maze[y][x] == 1;
+    }
+
+    int StepCost(int, int) const {
+        return 1;
+    }
+};
+
+// Flat per-cell results of a search, indexed by y * width + x. Cells are stamped
+// with the search generation, so a reused workspace starts a new search in O(1)
+// instead of clearing every cell.
+template <typename Cost>
+class SearchBuffers {
+public:
+    void Begin(size_t cell_count) {
+        if (_cells.size() != cell_count || _generation == std::numeric_limits<uint32_t>::max()) {
+            // Workspaces live as long as their thread, so memory from a much larger grid is given back
+            if (cell_count < _cells.size() / 4) {
+                std::vector<Cell>().swap(_cells);
+            }
+
+            _cells.assign(cell_count, Cell{ std::numeric_limits<Cost>::max(), -1, 0 });
+            _generation = 0;
+        }
+        ++_generation;
+    }
+
+    Cost GetDistance(int32_t index) const {
+        const Cell& cell = _cells[index];
+        return cell.generation == _generation ? cell.distance : std::numeric_limits<Cost>::max();
+    }
+
+    int32_t GetParent(int32_t index) const {
+        const Cell& cell = _cells[index];
+        return cell.generation == _generation ? cell.parent : -1;
+    }
+
+    void Set(int32_t index, Cost distance, int32_t parent) {
+        _cells[index] = Cell{ distance, parent, _generation };
+    }
+
+private:
+    struct Cell {
+        Cost distance;
+        int32_t parent;
+        uint32_t generation;
+    };
+
+    std::vector<Cell> _cells;
+    uint32_t _generation = 0;
+};
+
+template <typename Heuristic, typename Connectivity, typename Cost, template <typename> class Queue, typename Termination>
+class SearchKernel {
+public:
+    static constexpr Cost unreached = std::numeric_limits<Cost>::max();
+
+    // Returns true when the goal was reached; a negative goal_x explores the whole component
+    template <typename Grid>
+    static bool Run(const Grid& grid, int start_x, int start_y, int goal_x, int goal_y, SearchBuffers<Cost>& buffers) {
+        const int width = grid.width;
+        const int height = grid.height;
+
+        buffers.Begin(size_t(width) * size_t(height));
+
+        const int32_t start = start_y * width + start_x;
+        const int32_t goal = goal_x < 0 ? -1 : goal_y * width + goal_x;
+
+        Queue<Cost> open_set;
+        buffers.Set(start, 0, -1);
+        open_set.Push(start, Heuristic::template Estimate<Cost>(start_x, start_y, goal_x, goal_y));
+
+        while (!open_set.Empty()) {
+            SearchNode<Cost> current = open_set.Pop();
+
+            int x = current.index % width;
+            int y = current.index / width;
+            Cost g = buffers.GetDistance(current.index);
+
+            // Skip queue entries superseded by a cheaper push of the same cell
+            if (current.priority > g + Heuristic::template Estimate<Cost>(x, y, goal_x, goal_y))
+                continue;
+
+            if constexpr (Termination::stop_at_goal) {
+                if (current.index == goal)
+                    return true;
+            }
+
+            for (int i = 0; i < Connectivity::count; ++i) {
+                int nx = x + Connectivity::dx[i];
+                int ny = y + Connectivity::dy[i];
+
+                if (unsigned(nx) >= unsigned(width) || unsigned(ny) >= unsigned(height))
+                    continue;
+
+                if (!grid.Passable(nx, ny))
+                    continue;
+
+                int32_t next = ny * width + nx;
+                Cost tentative = g + Cost(grid.StepCost(nx, ny));
+
+                if (tentative < buffers.GetDistance(next)) {
+                    buffers.Set(next, tentative, current.index);
+                    open_set.Push(next, tentative + Heuristic::template Estimate<Cost>(nx, ny, goal_x, goal_y));
+                }
+            }
+        }
+
+        return goal >= 0 && buffers.GetDistance(goal) != unreached;
+    }
+};
+
+#endif // SEARCH_HPP
\ No newline at end of file
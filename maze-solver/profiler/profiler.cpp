@@ -0,0 +1,263 @@
+#include "profiler.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <format>
+#include <chrono>
+
+namespace {
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    // Nesting depth of open zones on this thread, used to stack them in the timeline
+    thread_local uint32_t zone_depth = 0;
+
+    std::string EscapeJson(const char* text) {
+        std::string out;
+        for (const char* c = text; *c; ++c) {
+            if (*c == '"' || *c == '\\') out += '\\';
+            out += *c;
+        }
+        return out;
+    }
+}
+
+Profiler::Profiler() {
+    _enabled = false;
+    _dropped = 0;
+    _frame_next = 0;
+    _frame_start = 0;
+    _collector_running = false;
+}
+
+Profiler::~Profiler() {
+    StopCollector();
+}
+
+void Profiler::SetEnabled(bool enabled) {
+    _enabled.store(enabled, std::memory_order_relaxed);
+
+    if (enabled) {
+        StartCollector();
+    }
+    else {
+        StopCollector();
+    }
+}
+
+void Profiler::StartCollector() {
+    std::lock_guard<std::mutex> lock(_collector_mutex);
+    if (_collector.joinable()) return;
+
+    _collector_running = true;
+    _collector = std::thread(&Profiler::CollectorLoop, this);
+}
+
+void Profiler::StopCollector() {
+    std::thread collector;
+    {
+        std::lock_guard<std::mutex> lock(_collector_mutex);
+        _collector_running = false;
+        collector.swap(_collector);
+    }
+
+    _collect_signal.notify_all();
+    if (collector.joinable()) collector.join();
+}
+
+void Profiler::CollectorLoop() {
+    std::unique_lock<std::mutex> lock(_collector_mutex);
+    while (_collector_running) {
+        _collect_signal.wait_for(lock, collect_interval);
+
+        lock.unlock();
+        Collect();
+        lock.lock();
+    }
+}
+
+bool Profiler::IsEnabled() const {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::Now() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+Profiler& Profiler::Shared() {
+    static Profiler profiler;
+    return profiler;
+}
+
+// Rings are owned by the profiler, so they outlive the threads that registered them
+Profiler::Ring& Profiler::GetThreadRing() {
+    thread_local Ring* ring = nullptr;
+
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(_rings_mutex);
+        _rings.push_back(std::make_unique<Ring>());
+        ring = _rings.back().get();
+        ring->thread_id = uint32_t(_rings.size() - 1);
+    }
+
+    return *ring;
+}
+
+// A full ring drops the zone instead of overwriting one the collector may be reading.
+// Never locks, so instrumented code cannot stall behind the GUI thread.
+void Profiler::Record(const char* name, uint64_t start_ns, uint64_t end_ns, uint32_t depth) {
+    Ring& ring = GetThreadRing();
+
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= ring_capacity) {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring.zones[head % ring_capacity] = Zone{ name, start_ns, end_ns, ring.thread_id, depth };
+    ring.head.store(head + 1, std::memory_order_release);
+
+    // Worker threads can fill their ring long before the next timer tick, so crossing the
+    // drain level wakes the collector early; a missed wake-up only delays it to the tick
+    if (head + 1 - ring.tail.load(std::memory_order_acquire) == ring_drain_level) {
+        _collect_signal.notify_one();
+    }
+}
+
+void Profiler::Drain(Ring& ring) {
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+
+    for (; tail < head; ++tail) {
+        _zones.push_back(ring.zones[tail % ring_capacity]);
+    }
+
+    ring.tail.store(tail, std::memory_order_release);
+
+    while (_zones.size() > history_capacity) {
+        _zones.pop_front();
+    }
+}
+
+// The frame is the outermost zone of the GUI thread, so zones inside it start one level down
+void Profiler::BeginFrame() {
+    _frame_start = Now();
+    ++zone_depth;
+}
+
+void Profiler::EndFrame() {
+    uint64_t end = Now();
+    --zone_depth;
+
+    if (IsEnabled()) {
+        Record("Frame", _frame_start, end, 0);
+    }
+
+    float frame_time = float(double(end - _frame_start) / 1e6);
+    if (_frame_times.size() < frame_history) {
+        _frame_times.push_back(frame_time);
+    }
+    else {
+        _frame_times[_frame_next] = frame_time;
+    }
+    _frame_next = (_frame_next + 1) % frame_history;
+
+    Collect();
+}
+
+void Profiler::Collect() {
+    std::lock_guard<std::mutex> rings_lock(_rings_mutex);
+    std::lock_guard<std::mutex> history_lock(_history_mutex);
+
+    for (const std::unique_ptr<Ring>& ring : _rings) {
+        Drain(*ring);
+    }
+}
+
+void Profiler::Clear() {
+    Collect();
+
+    std::lock_guard<std::mutex> lock(_history_mutex);
+    _zones.clear();
+    _frame_times.clear();
+    _frame_next = 0;
+    _dropped = 0;
+}
+
+// Copies under the lock, since worker threads may append to the history at any time
+std::vector<Profiler::Zone> Profiler::GetZones(uint64_t from_ns, uint64_t to_ns) const {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+
+    std::vector<Zone> zones;
+    for (const Zone& zone : _zones) {
+        if (zone.end_ns >= from_ns && zone.start_ns <= to_ns) {
+            zones.push_back(zone);
+        }
+    }
+    return zones;
+}
+
+size_t Profiler::GetZoneCount() const {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+    return _zones.size();
+}
+
+const std::vector<float>& Profiler::GetFrameTimes() const {
+    return _frame_times;
+}
+
+size_t Profiler::GetFrameOffset() const {
+    return _frame_times.size() < frame_history ? 0 : _frame_next;
+}
+
+size_t Profiler::GetThreadCount() const {
+    std::lock_guard<std::mutex> lock(_rings_mutex);
+    return _rings.size();
+}
+
+size_t Profiler::GetDroppedCount() const {
+    return _dropped.load(std::memory_order_relaxed);
+}
+
+// Complete ("X") events in microseconds, loadable in chrome://tracing and Perfetto
+bool Profiler::ExportChromeTrace(const std::string& filename) const {
+    std::lock_guard<std::mutex> lock(_history_mutex);
+
+    std::ofstream file(filename, std::ios::trunc);
+    if (!file) {
+        std::cerr << "[ERROR] Failed to open trace file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    for (const Zone& zone : _zones) {
+        file << std::format("{}{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":1,\"tid\":{}}}",
+            first ? "" : ",\n", EscapeJson(zone.name), zone.start_ns / 1000.0, (zone.end_ns - zone.start_ns) / 1000.0, zone.thread_id);
+        first = false;
+    }
+
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    file.flush();
+    if (!file) {
+        std::cerr << "[ERROR] Failed to write trace file: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+ProfileZone::ProfileZone(const char* name) {
+    _name = name;
+    _active = Profiler::Shared().IsEnabled();
+    _start = _active ? Profiler::Now() : 0;
+
+    if (_active) ++zone_depth;
+}
+
+ProfileZone::~ProfileZone() {
+    if (!_active) return;
+
+    --zone_depth;
+    Profiler::Shared().Record(_name, _start, Profiler::Now(), zone_depth);
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <vector>
+#include <deque>
+#include <array>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Scoped-zone profiler. Every thread writes finished zones into its own
+// single-producer ring without locking or waiting; the GUI thread drains all rings
+// once per frame into a bounded history used by the timeline and the trace export.
+// While enabled, a collector thread also drains them on a short timer, or early when
+// a ring passes half full, so an idle GUI does not turn bursts into dropped zones.
+// Recording starts disabled so nothing is kept without a consumer such as the GUI.
+class Profiler {
+public:
+    struct Zone {
+        const char* name; // must outlive the profiler, in practice a string literal
+        uint64_t start_ns;
+        uint64_t end_ns;
+        uint32_t thread_id;
+        uint32_t depth;
+    };
+
+    static constexpr size_t ring_capacity = 4096; // zones per thread between two drains
+    static constexpr size_t ring_drain_level = ring_capacity / 2;
+    static constexpr size_t history_capacity = 200000;
+    static constexpr size_t frame_history = 240;
+    static constexpr std::chrono::milliseconds collect_interval{ 20 };
+
+    Profiler();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    void SetEnabled(bool enabled); // also starts or joins the collector; call from one thread
+    bool IsEnabled() const;
+
+    void Record(const char* name, uint64_t start_ns, uint64_t end_ns, uint32_t depth);
+
+    void BeginFrame();
+    void EndFrame();
+    void Collect();
+    void Clear();
+
+    std::vector<Zone> GetZones(uint64_t from_ns, uint64_t to_ns) const; // zones overlapping the range
+    size_t GetZoneCount() const;
+
+    // Milliseconds in a ring buffer; the oldest entry is at GetFrameOffset once it is full
+    const std::vector<float>& GetFrameTimes() const;
+    size_t GetFrameOffset() const;
+
+    size_t GetThreadCount() const;
+    size_t GetDroppedCount() const;
+
+    bool ExportChromeTrace(const std::string& filename) const;
+
+    static uint64_t Now(); // nanoseconds since the profiler started
+    static Profiler& Shared();
+
+private:
+    struct Ring {
+        std::array<Zone, ring_capacity> zones;
+        std::atomic<uint64_t> head{ 0 }; // written by the owning thread
+        std::atomic<uint64_t> tail{ 0 }; // written by Collect
+        uint32_t thread_id = 0;
+    };
+
+    Ring& GetThreadRing();
+    void Drain(Ring& ring); // caller holds _history_mutex
+
+    void StartCollector();
+    void StopCollector();
+    void CollectorLoop();
+
+    std::atomic<bool> _enabled;
+    std::atomic<size_t> _dropped;
+
+    mutable std::mutex _rings_mutex; // guards registration only, never taken by Record
+    std::vector<std::unique_ptr<Ring>> _rings;
+
+    mutable std::mutex _history_mutex; // serialises the consumer side of every ring
+    std::deque<Zone> _zones;
+
+    std::thread _collector;
+    std::mutex _collector_mutex;
+    std::condition_variable _collect_signal; // notified by Record without taking the mutex
+    bool _collector_running;
+
+    std::vector<float> _frame_times;
+    size_t _frame_next;
+    uint64_t _frame_start;
+};
+
+// Records the time between construction and destruction as one zone on the current thread
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* _name;
+    uint64_t _start;
+    bool _active;
+};
+
+#endif // PROFILER_HPP
\ No newline at end of file
@@ -0,0 +1,269 @@
+#include "json.hpp"
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <climits>
+
+class JsonValue::Parser {
+public:
+    Parser(const std::string& text) : _text(text), _pos(0) {}
+
+    bool ParseDocument(JsonValue& out, std::string& error) {
+        if (!ParseValue(out, 0)) {
+            error = _error;
+            return false;
+        }
+
+        SkipWhitespace();
+        if (_pos != _text.size()) {
+            error = "trailing characters at offset " + std::to_string(_pos);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    static constexpr int max_depth = 32;
+
+    bool Fail(const char* message) {
+        _error = std::string(message) + " at offset " + std::to_string(_pos);
+        return false;
+    }
+
+    void SkipWhitespace() {
+        while (_pos < _text.size() && (_text[_pos] == ' ' || _text[_pos] == '\t' || _text[_pos] == '\r' || _text[_pos] == '\n'))
+            ++_pos;
+    }
+
+    bool Consume(const char* literal) {
+        size_t length = std::char_traits<char>::length(literal);
+        if (_text.compare(_pos, length, literal) != 0) return false;
+        _pos += length;
+        return true;
+    }
+
+    bool ParseValue(JsonValue& out, int depth) {
+        if (depth > max_depth) return Fail("nesting too deep");
+
+        SkipWhitespace();
+        if (_pos >= _text.size()) return Fail("unexpected end of input");
+
+        char c = _text[_pos];
+        if (c == '{') return ParseObject(out, depth);
+        if (c == '[') return ParseArray(out, depth);
+        if (c == '"') {
+            out._type = Type::String;
+            return ParseString(out._string);
+        }
+        if (Consume("true")) { out._type = Type::Bool; out._bool = true; return true; }
+        if (Consume("false")) { out._type = Type::Bool; out._bool = false; return true; }
+        if (Consume("null")) { out._type = Type::Null; return true; }
+        return ParseNumber(out);
+    }
+
+    bool ParseNumber(JsonValue& out) {
+        const char* begin = _text.c_str() + _pos;
+        char* end = nullptr;
+        double value = std::strtod(begin, &end);
+        if (end == begin) return Fail("invalid value");
+
+        _pos += size_t(end - begin);
+        out._type = Type::Number;
+        out._number = value;
+        return true;
+    }
+
+    bool ParseString(std::string& out) {
+        ++_pos; // opening quote
+        while (_pos < _text.size()) {
+            char c = _text[_pos++];
+            if (c == '"') return true;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+
+            if (_pos >= _text.size()) break;
+            char escape = _text[_pos++];
+            switch (escape) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                if (_pos + 4 > _text.size()) return Fail("truncated unicode escape");
+                unsigned code = unsigned(std::strtoul(_text.substr(_pos, 4).c_str(), nullptr, 16));
+                _pos += 4;
+
+                // Encode the BMP code point as UTF-8; paths are the only strings that need it
+                if (code < 0x80) {
+                    out += char(code);
+                }
+                else if (code < 0x800) {
+                    out += char(0xc0 | (code >> 6));
+                    out += char(0x80 | (code & 0x3f));
+                }
+                else {
+                    out += char(0xe0 | (code >> 12));
+                    out += char(0x80 | ((code >> 6) & 0x3f));
+                    out += char(0x80 | (code & 0x3f));
+                }
+                break;
+            }
+            default:
+                return Fail("invalid escape");
+            }
+        }
+
+        return Fail("unterminated string");
+    }
+
+    bool ParseArray(JsonValue& out, int depth) {
+        ++_pos; // [
+        out._type = Type::Array;
+
+        SkipWhitespace();
+        if (_pos < _text.size() && _text[_pos] == ']') {
+            ++_pos;
+            return true;
+        }
+
+        for (;;) {
+            out._array.emplace_back();
+            if (!ParseValue(out._array.back(), depth + 1)) return false;
+
+            SkipWhitespace();
+            if (_pos >= _text.size()) return Fail("unterminated array");
+            if (_text[_pos] == ',') { ++_pos; continue; }
+            if (_text[_pos] == ']') { ++_pos; return true; }
+            return Fail("expected ',' or ']'");
+        }
+    }
+
+    bool ParseObject(JsonValue& out, int depth) {
+        ++_pos; // {
+        out._type = Type::Object;
+
+        SkipWhitespace();
+        if (_pos < _text.size() && _text[_pos] == '}') {
+            ++_pos;
+            return true;
+        }
+
+        for (;;) {
+            SkipWhitespace();
+            if (_pos >= _text.size() || _text[_pos] != '"') return Fail("expected key");
+
+            std::string key;
+            if (!ParseString(key)) return false;
+
+            SkipWhitespace();
+            if (_pos >= _text.size() || _text[_pos] != ':') return Fail("expected ':'");
+            ++_pos;
+
+            out._object.emplace_back(std::move(key), JsonValue());
+            if (!ParseValue(out._object.back().second, depth + 1)) return false;
+
+            SkipWhitespace();
+            if (_pos >= _text.size()) return Fail("unterminated object");
+            if (_text[_pos] == ',') { ++_pos; continue; }
+            if (_text[_pos] == '}') { ++_pos; return true; }
+            return Fail("expected ',' or '}'");
+        }
+    }
+
+    const std::string& _text;
+    size_t _pos;
+    std::string _error;
+};
+
+JsonValue::JsonValue() {
+    _type = Type::Null;
+    _bool = false;
+    _number = 0.0;
+}
+
+bool JsonValue::Parse(const std::string& text, JsonValue& out, std::string& error) {
+    out = JsonValue();
+    Parser parser(text);
+    return parser.ParseDocument(out, error);
+}
+
+std::string JsonValue::Escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size() + 2);
+
+    for (char c : text) {
+        switch (c) {
+        case '"':  escaped += "\\\""; break;
+        case '\\': escaped += "\\\\"; break;
+        case '\n': escaped += "\\n"; break;
+        case '\r': escaped += "\\r"; break;
+        case '\t': escaped += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", unsigned(c));
+                escaped += buffer;
+            }
+            else {
+                escaped += c;
+            }
+        }
+    }
+
+    return escaped;
+}
+
+JsonValue::Type JsonValue::GetType() const {
+    return _type;
+}
+
+bool JsonValue::IsNull() const {
+    return _type == Type::Null;
+}
+
+bool JsonValue::AsBool(bool fallback) const {
+    return _type == Type::Bool ? _bool : fallback;
+}
+
+double JsonValue::AsNumber(double fallback) const {
+    return _type == Type::Number ? _number : fallback;
+}
+
+// Requests are untrusted, so anything that would not convert exactly gets the fallback
+int JsonValue::AsInt(int fallback) const {
+    if (_type != Type::Number || !std::isfinite(_number) || _number != std::trunc(_number))
+        return fallback;
+
+    if (_number < double(INT_MIN) || _number > double(INT_MAX))
+        return fallback;
+
+    return static_cast<int>(_number);
+}
+
+const std::string& JsonValue::AsString() const {
+    static const std::string empty;
+    return _type == Type::String ? _string : empty;
+}
+
+const std::vector<JsonValue>& JsonValue::AsArray() const {
+    static const std::vector<JsonValue> empty;
+    return _type == Type::Array ? _array : empty;
+}
+
+const JsonValue* JsonValue::Find(const std::string& key) const {
+    if (_type != Type::Object) return nullptr;
+
+    for (const auto& [name, value] : _object) {
+        if (name == key) return &value;
+    }
+
+    return nullptr;
+}
\ No newline at end of file
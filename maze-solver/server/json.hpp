@@ -0,0 +1,49 @@
+#ifndef JSON_HPP
+#define JSON_HPP
+
+#include <vector>
+#include <string>
+#include <utility>
+
+// Minimal JSON reader for the server's line protocol. Responses are small and
+// fixed-shape, so they are written directly with std::format.
+class JsonValue {
+public:
+    enum class Type {
+        Null = 0,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    JsonValue();
+
+    static bool Parse(const std::string& text, JsonValue& out, std::string& error);
+    static std::string Escape(const std::string& text);
+
+    Type GetType() const;
+    bool IsNull() const;
+
+    bool AsBool(bool fallback = false) const;
+    double AsNumber(double fallback = 0.0) const;
+    int AsInt(int fallback = 0) const;
+    const std::string& AsString() const;
+    const std::vector<JsonValue>& AsArray() const;
+
+    // Returns nullptr when this is not an object or the key is missing
+    const JsonValue* Find(const std::string& key) const;
+
+private:
+    class Parser;
+
+    Type _type;
+    bool _bool;
+    double _number;
+    std::string _string;
+    std::vector<JsonValue> _array;
+    std::vector<std::pair<std::string, JsonValue>> _object;
+};
+
+#endif // JSON_HPP
\ No newline at end of file
@@ -0,0 +1,588 @@
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include "server.hpp"
+#include "../image/image.hpp"
+#include "../cache/hash.hpp"
+#include "../pathfinder/pathfinder.hpp"
+#include "../pathfinder/distance_field.hpp"
+#include "../threading/thread_pool.hpp"
+
+#include <iostream>
+#include <format>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <cstring>
+
+namespace {
+#ifdef _WIN32
+    using NativeSocket = SOCKET;
+    const NativeSocket invalid_socket = INVALID_SOCKET;
+
+    void CloseSocket(NativeSocket socket) {
+        closesocket(socket);
+    }
+#else
+    using NativeSocket = int;
+    const NativeSocket invalid_socket = -1;
+
+    void CloseSocket(NativeSocket socket) {
+        close(socket);
+    }
+#endif
+
+    // A peer that hung up makes send fail with EPIPE instead of raising SIGPIPE,
+    // which would terminate the whole server. macOS uses SO_NOSIGPIPE on accept instead.
+#ifdef MSG_NOSIGNAL
+    constexpr int send_flags = MSG_NOSIGNAL;
+#else
+    constexpr int send_flags = 0;
+#endif
+
+    constexpr size_t max_fields_per_maze = 4;
+    constexpr size_t max_request_size = 64 * 1024 * 1024;
+
+    // Responses on one connection can finish out of order, so writes are serialised
+    struct Connection {
+        NativeSocket socket;
+        std::mutex write_mutex;
+        bool closed = false; // set once a write fails, later responses are dropped
+
+        ~Connection() {
+            CloseSocket(socket);
+        }
+
+        void Send(const std::string& line) {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            if (closed) return;
+
+            size_t sent = 0;
+            while (sent < line.size()) {
+                int chunk = static_cast<int>(std::min<size_t>(line.size() - sent, 1 << 20));
+                int result = send(socket, line.data() + sent, chunk, send_flags);
+                if (result <= 0) {
+                    closed = true;
+                    return;
+                }
+                sent += size_t(result);
+            }
+        }
+    };
+
+    std::string Error(const std::string& id, const std::string& message) {
+        return std::format("{{\"id\":{},\"ok\":false,\"error\":\"{}\"}}", id, JsonValue::Escape(message));
+    }
+
+    // Echoes the request id back verbatim so clients can match out-of-order responses
+    std::string FormatId(const JsonValue& request) {
+        const JsonValue* id = request.Find("id");
+        if (!id) return "null";
+
+        switch (id->GetType()) {
+        case JsonValue::Type::Number: return std::format("{}", id->AsNumber());
+        case JsonValue::Type::String: return "\"" + JsonValue::Escape(id->AsString()) + "\"";
+        default: return "null";
+        }
+    }
+
+    // Names accepted by SolverServer::Solve; anything else is rejected rather than run as A*
+    bool IsKnownAlgorithm(const std::string& algorithm) {
+        return algorithm == "astar" || algorithm == "dijkstra" || algorithm == "field";
+    }
+
+    bool ReadPoint(const JsonValue* value, ImVec2& point) {
+        if (!value || value->AsArray().size() != 2) return false;
+        point = ImVec2(float(value->AsArray()[0].AsInt(-1)), float(value->AsArray()[1].AsInt(-1)));
+        return true;
+    }
+
+    // Path as its start cell plus one U/R/D/L letter per move, or as explicit points
+    std::string FormatPath(const CompactPath& path, bool points) {
+        if (path.Empty()) return "\"length\":0";
+
+        ImVec2 start = path.GetStart();
+        std::string out = std::format("\"length\":{},\"start\":[{},{}],", path.GetLength(), int(start.x), int(start.y));
+
+        if (points) {
+            out += "\"path\":[";
+            bool first = true;
+            path.ForEachPoint([&](int x, int y) {
+                out += std::format("{}[{},{}]", first ? "" : ",", x, y);
+                first = false;
+            });
+            out += "]";
+        }
+        else {
+            static const char letters[4] = { 'U', 'R', 'D', 'L' };
+            out += "\"moves\":\"";
+            for (size_t i = 0; i < path.GetMoveCount(); ++i) {
+                out += letters[int(path.GetMove(i))];
+            }
+            out += "\"";
+        }
+
+        return out;
+    }
+
+    ThresholdSettings ReadThreshold(const JsonValue* value) {
+        ThresholdSettings settings;
+        if (!value) return settings;
+
+        const std::string& mode = value->Find("mode") ? value->Find("mode")->AsString() : "";
+        if (mode == "otsu") settings.mode = ThresholdSettings::Mode::Otsu;
+        else if (mode == "sauvola") settings.mode = ThresholdSettings::Mode::Sauvola;
+        else if (mode == "bradley") settings.mode = ThresholdSettings::Mode::Bradley;
+
+        if (const JsonValue* level = value->Find("level")) settings.level = level->AsInt(settings.level);
+        if (const JsonValue* radius = value->Find("radius")) settings.window_radius = radius->AsInt(settings.window_radius);
+        if (const JsonValue* k = value->Find("k")) settings.sauvola_k = float(k->AsNumber(settings.sauvola_k));
+        if (const JsonValue* t = value->Find("t")) settings.bradley_t = float(t->AsNumber(settings.bradley_t));
+        if (const JsonValue* open = value->Find("open")) settings.open_radius = open->AsInt(settings.open_radius);
+        if (const JsonValue* close = value->Find("close")) settings.close_radius = close->AsInt(settings.close_radius);
+
+        return settings;
+    }
+
+    double ElapsedMs(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+SolverServer::SolverServer(ThreadPool& pool)
+    : _pool(pool), _listen_socket(uintptr_t(invalid_socket)), _running(false), _pending(0) {
+#ifdef _WIN32
+    WSADATA wsa_data;
+    WSAStartup(MAKEWORD(2, 2), &wsa_data);
+#endif
+}
+
+SolverServer::~SolverServer() {
+    Stop();
+    Drain();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool SolverServer::Listen(const std::string& address) {
+    NativeSocket listen_socket = invalid_socket;
+
+    if (address.rfind("unix:", 0) == 0) {
+#ifdef _WIN32
+        std::cerr << "[ERROR] Unix domain sockets are not supported on this platform" << std::endl;
+        return false;
+#else
+        _unix_path = address.substr(5);
+
+        sockaddr_un endpoint{};
+        endpoint.sun_family = AF_UNIX;
+        if (_unix_path.empty() || _unix_path.size() >= sizeof(endpoint.sun_path)) {
+            std::cerr << "[ERROR] Invalid socket path: " << _unix_path << std::endl;
+            return false;
+        }
+        std::memcpy(endpoint.sun_path, _unix_path.c_str(), _unix_path.size() + 1);
+
+        unlink(_unix_path.c_str());
+        listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_socket == invalid_socket || bind(listen_socket, reinterpret_cast<sockaddr*>(&endpoint), sizeof(endpoint)) != 0) {
+            std::cerr << "[ERROR] Failed to bind " << address << std::endl;
+            if (listen_socket != invalid_socket) CloseSocket(listen_socket);
+            return false;
+        }
+#endif
+    }
+    else {
+        std::string host = "127.0.0.1";
+        std::string port = address;
+
+        size_t colon = address.rfind(':');
+        if (colon != std::string::npos) {
+            host = address.substr(0, colon);
+            port = address.substr(colon + 1);
+        }
+
+        sockaddr_in endpoint{};
+        endpoint.sin_family = AF_INET;
+        endpoint.sin_port = htons(static_cast<unsigned short>(std::atoi(port.c_str())));
+        if (inet_pton(AF_INET, host.c_str(), &endpoint.sin_addr) != 1) {
+            std::cerr << "[ERROR] Invalid listen address: " << address << std::endl;
+            return false;
+        }
+
+        listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listen_socket == invalid_socket) {
+            std::cerr << "[ERROR] Failed to create socket" << std::endl;
+            return false;
+        }
+
+        int reuse = 1;
+        setsockopt(listen_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+        if (bind(listen_socket, reinterpret_cast<sockaddr*>(&endpoint), sizeof(endpoint)) != 0) {
+            std::cerr << "[ERROR] Failed to bind " << address << std::endl;
+            CloseSocket(listen_socket);
+            return false;
+        }
+    }
+
+    if (listen(listen_socket, SOMAXCONN) != 0) {
+        std::cerr << "[ERROR] Failed to listen on " << address << std::endl;
+        CloseSocket(listen_socket);
+        return false;
+    }
+
+    _listen_socket = uintptr_t(listen_socket);
+    _running = true;
+    std::cout << "[INFO] Listening on " << address << std::endl;
+    return true;
+}
+
+void SolverServer::Run() {
+    while (_running) {
+        NativeSocket client = accept(NativeSocket(_listen_socket), nullptr, nullptr);
+        if (client == invalid_socket) {
+            if (!_running) break;
+            continue;
+        }
+
+#ifdef SO_NOSIGPIPE
+        int no_sigpipe = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+
+        // Checked under the lock so Stop either sees this client or it is never started
+        if (!_running) {
+            CloseSocket(client);
+            break;
+        }
+
+        // Finished readers are joined here so the list only holds live connections
+        for (auto it = _clients.begin(); it != _clients.end();) {
+            if (it->finished) {
+                it->thread.join();
+                it = _clients.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        // One reader per connection; the requests themselves run on the pool
+        Client& entry = _clients.emplace_back();
+        entry.socket = uintptr_t(client);
+        entry.thread = std::thread(&SolverServer::ServeConnection, this, std::ref(entry));
+    }
+
+    Drain();
+}
+
+void SolverServer::Stop() {
+    if (!_running.exchange(false)) return;
+
+    NativeSocket listen_socket = NativeSocket(_listen_socket);
+    _listen_socket = uintptr_t(invalid_socket);
+
+#ifndef _WIN32
+    shutdown(listen_socket, SHUT_RDWR);
+#endif
+    CloseSocket(listen_socket);
+
+#ifndef _WIN32
+    if (!_unix_path.empty()) unlink(_unix_path.c_str());
+#endif
+}
+
+// Wakes and joins every reader, then waits for the requests they queued on the pool.
+// The readers are shut down here rather than in Stop, because the accept loop can reach
+// Drain before Stop gets the client list.
+void SolverServer::Drain() {
+    std::list<Client> clients;
+    {
+        std::lock_guard<std::mutex> lock(_clients_mutex);
+
+        // Only the receiving side is closed, so responses still in flight are delivered
+        for (Client& client : _clients) {
+            if (client.finished) continue;
+#ifdef _WIN32
+            shutdown(NativeSocket(client.socket), SD_RECEIVE);
+#else
+            shutdown(NativeSocket(client.socket), SHUT_RD);
+#endif
+        }
+        clients.swap(_clients);
+    }
+
+    for (Client& client : clients) {
+        if (client.thread.joinable()) client.thread.join();
+    }
+
+    std::unique_lock<std::mutex> lock(_pending_mutex);
+    _pending_done.wait(lock, [this] { return _pending == 0; });
+}
+
+void SolverServer::ServeConnection(Client& client) {
+    auto connection = std::make_shared<Connection>();
+    connection->socket = NativeSocket(client.socket);
+
+    std::string buffer;
+    char chunk[64 * 1024];
+
+    for (;;) {
+        int received = recv(connection->socket, chunk, sizeof(chunk), 0);
+        if (received <= 0) break;
+
+        buffer.append(chunk, size_t(received));
+
+        size_t line_start = 0;
+        for (size_t newline; (newline = buffer.find('\n', line_start)) != std::string::npos; line_start = newline + 1) {
+            std::string line = buffer.substr(line_start, newline - line_start);
+            if (line.empty() || line == "\r") continue;
+
+            {
+                std::lock_guard<std::mutex> lock(_pending_mutex);
+                ++_pending;
+            }
+
+            _pool.Submit([this, connection, line = std::move(line)] {
+                connection->Send(HandleRequest(line) + "\n");
+
+                // Notified under the lock so Drain cannot return while this task still touches the server
+                std::lock_guard<std::mutex> lock(_pending_mutex);
+                if (--_pending == 0) _pending_done.notify_all();
+            });
+        }
+        buffer.erase(0, line_start);
+
+        if (buffer.size() > max_request_size) {
+            connection->Send(Error("null", "request too large") + "\n");
+            break;
+        }
+    }
+
+    // The socket stays open until queued responses are sent, but Stop must no longer touch it
+    std::lock_guard<std::mutex> lock(_clients_mutex);
+    client.finished = true;
+}
+
+std::string SolverServer::HandleRequest(const std::string& line) {
+    JsonValue request;
+    std::string parse_error;
+    if (!JsonValue::Parse(line, request, parse_error)) {
+        return Error("null", "invalid JSON: " + parse_error);
+    }
+
+    const JsonValue* op = request.Find("op");
+    const std::string& name = op ? op->AsString() : "";
+
+    if (name == "load") return HandleLoad(request);
+    if (name == "solve") return HandleSolve(request);
+    if (name == "batch_solve") return HandleBatchSolve(request);
+    if (name == "unload") return HandleUnload(request);
+    if (name == "list") return HandleList(request);
+    if (name == "shutdown") {
+        Stop();
+        return std::format("{{\"id\":{},\"ok\":true}}", FormatId(request));
+    }
+
+    return Error(FormatId(request), "unknown op '" + name + "'");
+}
+
+std::shared_ptr<SolverServer::LoadedMaze> SolverServer::FindMaze(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(_mazes_mutex);
+    auto it = _mazes.find(name);
+    return it != _mazes.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<DistanceField> SolverServer::GetDistanceField(LoadedMaze& maze, ImVec2 goal_pos) {
+    std::lock_guard<std::mutex> lock(maze.field_mutex);
+
+    for (auto it = maze.fields.begin(); it != maze.fields.end(); ++it) {
+        if ((*it)->IsValidFor(maze.hash, goal_pos)) {
+            maze.fields.splice(maze.fields.begin(), maze.fields, it);
+            return maze.fields.front();
+        }
+    }
+
+    auto field = std::make_shared<DistanceField>();
+    field->Build(maze.maze, maze.hash, goal_pos, _pool);
+
+    maze.fields.push_front(field);
+    if (maze.fields.size() > max_fields_per_maze) {
+        maze.fields.pop_back();
+    }
+
+    return field;
+}
+
+CompactPath SolverServer::Solve(LoadedMaze& maze, ImVec2 start_pos, ImVec2 end_pos, const std::string& algorithm) {
+    if (!Pathfinder::CanReach(maze.components, maze.width, start_pos, end_pos))
+        return {};
+
+    if (algorithm == "dijkstra")
+        return Pathfinder::SolveMazeWithDijkstra(maze.maze, start_pos, end_pos);
+
+    if (algorithm == "field")
+        return GetDistanceField(maze, end_pos)->Descend(start_pos);
+
+    return Pathfinder::SolveMazeWithAStar(maze.maze, start_pos, end_pos);
+}
+
+std::string SolverServer::HandleLoad(const JsonValue& request) {
+    std::string id = FormatId(request);
+    const JsonValue* name = request.Find("name");
+    const JsonValue* path = request.Find("path");
+
+    if (!name || name->AsString().empty() || !path || path->AsString().empty())
+        return Error(id, "load needs 'name' and 'path'");
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    Image image;
+    if (!image.LoadFromFile(path->AsString()))
+        return Error(id, "failed to load image '" + path->AsString() + "'");
+
+    image.ApplyGreyscaleFilter();
+
+    auto loaded = std::make_shared<LoadedMaze>();
+    loaded->name = name->AsString();
+    loaded->filename = path->AsString();
+    loaded->width = image.GetWidth();
+    loaded->height = image.GetHeight();
+    loaded->maze = image.ConvertToMazeGrid(ReadThreshold(request.Find("threshold")));
+    loaded->components = Pathfinder::LabelComponents(loaded->maze);
+    loaded->hash = HashMazeGrid(loaded->maze);
+
+    auto [top_left, bottom_right] = image.CalculateMazeBoundingBox();
+    ImVec2 start_pos, end_pos;
+    std::string openings = Pathfinder::FindBorderOpenings(loaded->maze, top_left, bottom_right, start_pos, end_pos)
+        ? std::format(",\"openings\":[[{},{}],[{},{}]]", int(start_pos.x), int(start_pos.y), int(end_pos.x), int(end_pos.y))
+        : "";
+
+    {
+        std::unique_lock<std::shared_mutex> lock(_mazes_mutex);
+        _mazes[loaded->name] = loaded;
+    }
+
+    return std::format("{{\"id\":{},\"ok\":true,\"width\":{},\"height\":{},\"hash\":\"{:016x}\"{},\"time_ms\":{:.3f}}}",
+        id, loaded->width, loaded->height, loaded->hash, openings, ElapsedMs(start));
+}
+
+std::string SolverServer::HandleSolve(const JsonValue& request) {
+    std::string id = FormatId(request);
+    const JsonValue* name = request.Find("name");
+
+    std::shared_ptr<LoadedMaze> maze = FindMaze(name ? name->AsString() : "");
+    if (!maze)
+        return Error(id, "maze not loaded");
+
+    ImVec2 start_pos, end_pos;
+    if (!ReadPoint(request.Find("start"), start_pos) || !ReadPoint(request.Find("end"), end_pos))
+        return Error(id, "solve needs 'start' and 'end' as [x, y]");
+
+    const JsonValue* algorithm_value = request.Find("algorithm");
+    std::string algorithm = algorithm_value ? algorithm_value->AsString() : "astar";
+    if (!IsKnownAlgorithm(algorithm))
+        return Error(id, "unknown algorithm '" + algorithm + "'");
+
+    const JsonValue* points = request.Find("points");
+
+    auto start = std::chrono::high_resolution_clock::now();
+    CompactPath path = Solve(*maze, start_pos, end_pos, algorithm);
+    double elapsed = ElapsedMs(start);
+
+    return std::format("{{\"id\":{},\"ok\":true,{},\"time_ms\":{:.3f}}}", id, FormatPath(path, points && points->AsBool()), elapsed);
+}
+
+// Pairs are [start_x, start_y, end_x, end_y]; each pair is solved in parallel against the shared grid
+std::string SolverServer::HandleBatchSolve(const JsonValue& request) {
+    std::string id = FormatId(request);
+    const JsonValue* name = request.Find("name");
+
+    std::shared_ptr<LoadedMaze> maze = FindMaze(name ? name->AsString() : "");
+    if (!maze)
+        return Error(id, "maze not loaded");
+
+    const JsonValue* pairs_value = request.Find("pairs");
+    if (!pairs_value || pairs_value->GetType() != JsonValue::Type::Array)
+        return Error(id, "batch_solve needs 'pairs' as [[sx, sy, ex, ey], ...]");
+
+    const std::vector<JsonValue>& pairs = pairs_value->AsArray();
+    for (const JsonValue& pair : pairs) {
+        if (pair.AsArray().size() != 4)
+            return Error(id, "each pair must be [sx, sy, ex, ey]");
+    }
+
+    const JsonValue* algorithm_value = request.Find("algorithm");
+    std::string algorithm = algorithm_value ? algorithm_value->AsString() : "astar";
+    if (!IsKnownAlgorithm(algorithm))
+        return Error(id, "unknown algorithm '" + algorithm + "'");
+
+    const JsonValue* points = request.Find("points");
+    bool as_points = points && points->AsBool();
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<std::string> results(pairs.size());
+    _pool.ParallelFor(0, pairs.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const std::vector<JsonValue>& pair = pairs[i].AsArray();
+            ImVec2 start_pos(float(pair[0].AsInt(-1)), float(pair[1].AsInt(-1)));
+            ImVec2 end_pos(float(pair[2].AsInt(-1)), float(pair[3].AsInt(-1)));
+
+            results[i] = "{" + FormatPath(Solve(*maze, start_pos, end_pos, algorithm), as_points) + "}";
+        }
+    });
+
+    std::string out = std::format("{{\"id\":{},\"ok\":true,\"results\":[", id);
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (i) out += ',';
+        out += results[i];
+    }
+    out += std::format("],\"time_ms\":{:.3f}}}", ElapsedMs(start));
+
+    return out;
+}
+
+std::string SolverServer::HandleUnload(const JsonValue& request) {
+    std::string id = FormatId(request);
+    const JsonValue* name = request.Find("name");
+
+    size_t erased = 0;
+    {
+        std::unique_lock<std::shared_mutex> lock(_mazes_mutex);
+        erased = _mazes.erase(name ? name->AsString() : "");
+    }
+
+    // In-flight solves keep their shared_ptr, so the grid is freed when the last one finishes
+    if (!erased)
+        return Error(id, "maze not loaded");
+
+    return std::format("{{\"id\":{},\"ok\":true}}", id);
+}
+
+std::string SolverServer::HandleList(const JsonValue& request) {
+    std::shared_lock<std::shared_mutex> lock(_mazes_mutex);
+
+    std::string out = std::format("{{\"id\":{},\"ok\":true,\"mazes\":[", FormatId(request));
+    bool first = true;
+    for (const auto& [name, maze] : _mazes) {
+        out += std::format("{}{{\"name\":\"{}\",\"path\":\"{}\",\"width\":{},\"height\":{}}}",
+            first ? "" : ",", JsonValue::Escape(name), JsonValue::Escape(maze->filename), maze->width, maze->height);
+        first = false;
+    }
+    out += "]}";
+
+    return out;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include "json.hpp"
+#include "../path/path.hpp"
+
+#include <imgui.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <shared_mutex>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+
+class ThreadPool;
+class DistanceField;
+
+// Resident solver service. Converted grids stay in memory between requests and
+// are shared read-only by concurrent solves; requests arrive as JSON lines over
+// localhost TCP or, on POSIX, a Unix domain socket.
+class SolverServer {
+public:
+    explicit SolverServer(ThreadPool& pool);
+    ~SolverServer();
+
+    // "127.0.0.1:7878", "7878" or "unix:/path/to/socket"
+    bool Listen(const std::string& address);
+    void Run();       // returns once stopped and every connection and request has finished
+    void Stop();      // safe to call from a request; stops accepting and ends every connection
+
+    // Handles one request line and returns the response line, without the newline
+    std::string HandleRequest(const std::string& line);
+
+private:
+    struct LoadedMaze {
+        std::string name;
+        std::string filename;
+        uint64_t hash = 0;
+        int width = 0;
+        int height = 0;
+        std::vector<std::vector<int>> maze;
+        std::vector<int32_t> components;
+
+        // Goal-rooted fields for the "field" algorithm, most recently used first
+        std::mutex field_mutex;
+        std::list<std::shared_ptr<DistanceField>> fields;
+    };
+
+    std::shared_ptr<LoadedMaze> FindMaze(const std::string& name) const;
+    std::shared_ptr<DistanceField> GetDistanceField(LoadedMaze& maze, ImVec2 goal_pos);
+    CompactPath Solve(LoadedMaze& maze, ImVec2 start_pos, ImVec2 end_pos, const std::string& algorithm);
+
+    std::string HandleLoad(const JsonValue& request);
+    std::string HandleSolve(const JsonValue& request);
+    std::string HandleBatchSolve(const JsonValue& request);
+    std::string HandleUnload(const JsonValue& request);
+    std::string HandleList(const JsonValue& request);
+
+    struct Client {
+        std::thread thread;
+        uintptr_t socket;
+        bool finished = false;
+    };
+
+    void ServeConnection(Client& client);
+    void Drain();
+
+    ThreadPool& _pool;
+
+    mutable std::shared_mutex _mazes_mutex;
+    std::unordered_map<std::string, std::shared_ptr<LoadedMaze>> _mazes;
+
+    uintptr_t _listen_socket; // SOCKET on Windows, a file descriptor elsewhere
+    std::string _unix_path;
+    std::atomic<bool> _running;
+
+    // Readers and queued requests use this object, so it must not be destroyed before they end
+    std::mutex _clients_mutex;
+    std::list<Client> _clients;
+
+    std::mutex _pending_mutex;
+    std::condition_variable _pending_done;
+    size_t _pending;
+};
+
+#endif // SERVER_HPP
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    _active = 0;
+    _stopping = false;
+
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    _workers.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        _workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _task_available.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push(std::move(task));
+    }
+    _task_available.notify_one();
+}
+
+void ThreadPool::WaitIdle() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _tasks.empty() && _active == 0; });
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& body) {
+    if (begin >= end) return;
+
+    struct ParallelState {
+        size_t begin, end, chunk_size, chunk_count;
+        const std::function<void(size_t, size_t)>* body;
+        std::atomic<size_t> next_chunk{ 0 };
+        std::atomic<size_t> done_chunks{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    // A few chunks per thread keeps the load balanced when bands differ in cost
+    size_t count = end - begin;
+    size_t chunk_count = std::min(count, (_workers.size() + 1) * 4);
+
+    auto shared = std::make_shared<ParallelState>();
+    shared->begin = begin;
+    shared->end = end;
+    shared->chunk_count = chunk_count;
+    shared->chunk_size = (count + chunk_count - 1) / chunk_count;
+    shared->body = &body;
+
+    auto RunChunks = [](ParallelState& state) {
+        for (;;) {
+            size_t chunk = state.next_chunk.fetch_add(1);
+            if (chunk >= state.chunk_count) return;
+
+            size_t chunk_begin = state.begin + chunk * state.chunk_size;
+            size_t chunk_end = std::min(state.end, chunk_begin + state.chunk_size);
+            if (chunk_begin < chunk_end) {
+                (*state.body)(chunk_begin, chunk_end);
+            }
+
+            if (state.done_chunks.fetch_add(1) + 1 == state.chunk_count) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                state.finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(_workers.size(), chunk_count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        Submit([shared, RunChunks] { RunChunks(*shared); });
+    }
+
+    RunChunks(*shared);
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&] { return shared->done_chunks.load() == shared->chunk_count; });
+}
+
+size_t ThreadPool::GetThreadCount() const {
+    return _workers.size();
+}
+
+size_t ThreadPool::GetPendingCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tasks.size() + _active;
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _task_available.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+
+            if (_stopping && _tasks.empty()) return;
+
+            task = std::move(_tasks.front());
+            _tasks.pop();
+            ++_active;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_active;
+            if (_tasks.empty() && _active == 0) {
+                _idle.notify_all();
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstddef>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count = 0); // 0 picks hardware_concurrency
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+    void WaitIdle();
+
+    // Splits [begin, end) into chunks run on the pool and blocks until all are done.
+    // The calling thread works on chunks too, so it is safe to call from a pool task.
+    void ParallelFor(size_t begin, size_t end, const std::function<void(size_t, size_t)>& body);
+
+    size_t GetThreadCount() const;
+    size_t GetPendingCount() const;
+
+    static ThreadPool& Shared();
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> _workers;
+    std::queue<std::function<void()>> _tasks;
+    mutable std::mutex _mutex;
+    std::condition_variable _task_available;
+    std::condition_variable _idle;
+    size_t _active;
+    bool _stopping;
+};
+
+#endif // THREAD_POOL_HPP
\ No newline at end of file
@@ -2,16 +2,45 @@
 
 #include "../../image/image.hpp"
 #include "../../pathfinder/pathfinder.hpp"
-
+#include "../../pathfinder/distance_field.hpp"
+#include "../../pathfinder/clearance.hpp"
+#include "../../cache/hash.hpp"
+#include "../../cache/solve_cache.hpp"
+#include "../../cache/grid_cache.hpp"
+#include "../../path/path_export.hpp"
+#include "../../batch/batch_queue.hpp"
+#include "../../threading/thread_pool.hpp"
+#include "../../profiler/profiler.hpp"
+
+#include <imgui_internal.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
+#include <tinyfiledialogs.h>
 #include <iostream>
 #include <format>
 #include <algorithm>
 #include <chrono>
+#include <filesystem>
+#include <random>
+#include <unordered_set>
+#include <cmath>
+#include <unordered_map>
+#include <string_view>
+#include <cstring>
 
 Image image;
 Pathfinder pathfinder;
+SolveCache solve_cache;
+GridCache grid_cache("maze-cache");
+BatchQueue batch_queue(ThreadPool::Shared(), &grid_cache);
+Thresholder thresholder;
+DistanceField distance_field;
+MazePyramid pyramid;
+ClearanceMap clearance_map;
+
+namespace {
+    constexpr size_t max_polyline_points = 8192;
+}
 
 GUI::GUI() {
     _running = true;
@@ -29,6 +58,25 @@ GUI::GUI() {
     _bounding_box_color = ImVec4(1.0f, 0.0f, 0.0f, 1.0f);
     _solve_time = 0.0f;
     _show_popup = false;
+    _popup_message = "";
+    _redraw_frames = 3;
+    _was_busy = false;
+    _maze_hash = 0;
+    _persistent_cache = false;
+    _viewed_batch_item = -1;
+    _threshold_preview = false;
+    _hover_preview = false;
+    _agent_method = MultiAgentPlanner::Method::Prioritized;
+    _random_agent_count = 20;
+    _measure_gap = false;
+    _snap_endpoints = true;
+    _snap_clearance = 2.0f;
+    _min_clearance = 1.0f;
+    _wall_penalty = 2.0f;
+    _show_profiler = false;
+    _profiler_paused = false;
+    _profiler_window_ms = 100.0f;
+    _profiler_view_end = 0;
 }
 
 GUI::~GUI() {
@@ -45,9 +93,13 @@ void GUI::Init(GLFWwindow* window) {
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init();
     SetupImGuiStyle();
+
+    // The GUI drains the profiler every frame, so recording is only worth it once it exists
+    Profiler::Shared().SetEnabled(true);
 }
 
 void GUI::Shutdown() {
+    Profiler::Shared().SetEnabled(false);
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
@@ -55,31 +107,46 @@ void GUI::Shutdown() {
 }
 
 void GUI::BeginFrame() {
+    if (_redraw_frames > 0) {
+        --_redraw_frames;
+    }
+
+    _was_busy = batch_queue.IsBusy();
+    Profiler::Shared().BeginFrame();
+
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
 }
 
 void GUI::EndFrame(GLFWwindow* window) {
-    ImGui::Render();
-    int display_width, display_height;
-    glfwGetFramebufferSize(window, &display_width, &display_height);
-    glViewport(0, 0, display_width, display_height);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    // Scoped so the zone is recorded before the profiler closes the frame
+    {
+        ProfileZone zone("Frame Render");
+        ImGui::Render();
+        int display_width, display_height;
+        glfwGetFramebufferSize(window, &display_width, &display_height);
+        glViewport(0, 0, display_width, display_height);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+        if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
+            GLFWwindow* backup_context = glfwGetCurrentContext();
+            ImGui::UpdatePlatformWindows();
+            ImGui::RenderPlatformWindowsDefault();
+            glfwMakeContextCurrent(backup_context);
+        }
 
-    if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
-        GLFWwindow* backup_context = glfwGetCurrentContext();
-        ImGui::UpdatePlatformWindows();
-        ImGui::RenderPlatformWindowsDefault();
-        glfwMakeContextCurrent(backup_context);
+        glfwSwapBuffers(window);
     }
 
-    glfwSwapBuffers(window);
+    Profiler::Shared().EndFrame();
 }
 
 void GUI::Render() {
+    ProfileZone zone("UI Build");
+
     ImGui::SetNextWindowSize(ImVec2(1000, 600), ImGuiCond_Once);
     ImGui::Begin("Maze Solver", &_running, ImGuiWindowFlags_NoCollapse);
 
@@ -91,6 +158,10 @@ void GUI::Render() {
     RenderImagePanel();
 
     ImGui::End();
+
+    if (_show_profiler) {
+        RenderProfilerWindow();
+    }
 }
 
 void GUI::RenderControlsPanel() {
@@ -107,10 +178,19 @@ void GUI::RenderControlsPanel() {
 
         image.ApplyGreyscaleFilter();
 
-        _solved_path.clear();
+        SetSolvedPath({});
+        _viewed_batch_item = -1;
+        thresholder.Reset();
 
         if (_image_texture) {
-            _maze = image.ConvertToMazeGrid();
+            ConvertMaze();
+        }
+    }
+
+    if (ImGui::Button("Load Folder", ImVec2(-1, 35))) {
+        const char* folder = tinyfd_selectFolderDialog("Choose Maze Folder", "");
+        if (folder) {
+            batch_queue.AddFolder(folder, _threshold_settings);
         }
     }
 
@@ -123,12 +203,26 @@ void GUI::RenderControlsPanel() {
     ImGui::RadioButton("Dijkstra", (int*)&_algorithm, (int)Alg::Dijkstra);
     ImGui::SameLine();
     ImGui::RadioButton("A*", (int*)&_algorithm, (int)Alg::AStar);
+    ImGui::SameLine();
+    ImGui::RadioButton("Goal Field", (int*)&_algorithm, (int)Alg::DistanceField);
+    ImGui::SameLine();
+    ImGui::RadioButton("Coarse-to-Fine", (int*)&_algorithm, (int)Alg::Pyramid);
+    ImGui::SameLine();
+    ImGui::RadioButton("Clearance-Aware", (int*)&_algorithm, (int)Alg::Clearance);
+    if (_algorithm == Alg::Pyramid) {
+        ImGui::Checkbox("Measure Optimality Gap", &_measure_gap);
+    }
+    if (_algorithm == Alg::Clearance) {
+        ImGui::SliderFloat("Min Clearance", &_min_clearance, 1.0f, 16.0f, "%.1f px");
+        ImGui::SliderFloat("Wall Penalty", &_wall_penalty, 0.0f, 10.0f, "%.1f");
+    }
+    ImGui::Checkbox("Hover Preview", &_hover_preview);
 
     ImGui::Separator();
 
     if (_show_popup) {
         if (ImGui::BeginPopupModal("Pathfinder", nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
-            ImGui::Text("Failed to find a path");
+            ImGui::TextUnformatted(_popup_message);
             if (ImGui::Button("OK")) {
                 ImGui::CloseCurrentPopup();
                 _show_popup = false;
@@ -137,6 +231,8 @@ void GUI::RenderControlsPanel() {
         }
     }
 
+    RenderBatchPanel();
+
     if (_image_texture) {
         ImGui::Text("Set Positions:");
 
@@ -150,26 +246,95 @@ void GUI::RenderControlsPanel() {
             _current_mode = PositionMode::SetEnd;
         }
 
+        ImGui::Checkbox("Snap to Open Space", &_snap_endpoints);
+        if (_snap_endpoints) {
+            ImGui::SliderFloat("Snap Clearance", &_snap_clearance, 1.0f, 8.0f, "%.1f px");
+        }
+
         if (ImGui::Button("Solve Maze")) {
 
             auto start = std::chrono::high_resolution_clock::now();
 
-            _solved_path.clear();
+            ImVec2 start_pos = image.GetStartPosition();
+            ImVec2 end_pos = image.GetEndPosition();
+
+            // Endpoints placed before Min Clearance was raised can sit on cells this search treats as walls
+            bool blocked = false;
+            if (_algorithm == Alg::Clearance) {
+                if (!clearance_map.IsValidFor(_maze_hash)) {
+                    clearance_map.Build(_maze, _maze_hash, ThreadPool::Shared());
+                }
+
+                for (ImVec2* pos : { &start_pos, &end_pos }) {
+                    if (clearance_map.GetClearance(int(pos->x), int(pos->y)) < _min_clearance) {
+                        clearance_map.Snap(*pos, _min_clearance, _components, _component_sizes);
+                        blocked |= clearance_map.GetClearance(int(pos->x), int(pos->y)) < _min_clearance;
+                    }
+                }
+
+                image.SetStartPosition(start_pos);
+                image.SetEndPosition(end_pos);
+            }
+
+            SolveCache::Key key{ _maze_hash, int(start_pos.x), int(start_pos.y), int(end_pos.x), int(end_pos.y), int(_algorithm) };
+
+            // The clearance settings change which cells are open, so they belong to the grid key
+            if (_algorithm == Alg::Clearance) {
+                float settings[2] = { _min_clearance, _wall_penalty };
+                key.grid_hash = HashBytes(settings, sizeof(settings), _maze_hash);
+            }
 
-            switch (_algorithm) {
-            case Alg::Dijkstra:
-                _solved_path = pathfinder.SolveMazeWithDijkstra(_maze, image.GetStartPosition(), image.GetEndPosition());
-                break;
-            case Alg::AStar:
-                _solved_path = pathfinder.SolveMazeWithAStar(_maze, image.GetStartPosition(), image.GetEndPosition());
-                break;
+            // Coarse-to-fine results carry level and gap statistics the cache cannot hold, so they always re-solve
+            bool cacheable = _algorithm != Alg::Pyramid;
+            const CompactPath* cached = cacheable && !blocked ? solve_cache.Find(key) : nullptr;
+
+            if (blocked) {
+                SetSolvedPath({});
+            }
+            else if (cached) {
+                SetSolvedPath(*cached);
+            }
+            else {
+                CompactPath path;
+                _pyramid_result = {};
+
+                // Endpoints in different components can never be joined, skip the flood fill
+                if (pathfinder.CanReach(_components, image.GetWidth(), start_pos, end_pos)) {
+                    switch (_algorithm) {
+                    case Alg::Dijkstra:
+                        path = pathfinder.SolveMazeWithDijkstra(_maze, start_pos, end_pos);
+                        break;
+                    case Alg::AStar:
+                        path = pathfinder.SolveMazeWithAStar(_maze, start_pos, end_pos);
+                        break;
+                    case Alg::DistanceField:
+                        path = GetDistanceField().Descend(start_pos);
+                        break;
+                    case Alg::Pyramid:
+                        if (!pyramid.IsValidFor(_maze_hash)) {
+                            pyramid.Build(_maze, _maze_hash, ThreadPool::Shared());
+                        }
+                        _pyramid_result = pyramid.Solve(start_pos, end_pos, 2, _measure_gap);
+                        path = _pyramid_result.path;
+                        break;
+                    case Alg::Clearance:
+                        path = pathfinder.SolveWithClearance(clearance_map, start_pos, end_pos, _min_clearance, _wall_penalty);
+                        break;
+                    }
+                }
+
+                if (cacheable) {
+                    solve_cache.Insert(key, path);
+                }
+                SetSolvedPath(std::move(path));
             }
 
             auto end = std::chrono::high_resolution_clock::now();
 
             _solve_time = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
             
-            if (!_solved_path.size()) {
+            if (_solved_path.Empty()) {
+                _popup_message = blocked ? "No cell near the start or end has the minimum clearance" : "Failed to find a path";
                 _show_popup = true;
                 ImGui::OpenPopup("Pathfinder");
             }
@@ -177,6 +342,9 @@ void GUI::RenderControlsPanel() {
 
         ImGui::Separator();
 
+        RenderThresholdSettings();
+        RenderMultiAgentPanel();
+        RenderExportSettings();
         RenderAdvancedSettings();
     }
 
@@ -206,8 +374,10 @@ void GUI::RenderImagePanel() {
     ImGui::SetCursorPos(image_pos);
     ImVec2 screen_pos = ImGui::GetCursorScreenPos();
 
-    ImGui::Image((void*)(intptr_t)_image_texture, ImVec2(img_width, img_height));
+    GLuint texture = (_threshold_preview && image.GetPreviewTexture()) ? image.GetPreviewTexture() : _image_texture;
+    ImGui::Image((void*)(intptr_t)texture, ImVec2(img_width, img_height));
     RenderOverlay(screen_pos, img_width, img_height);
+    RenderHoverPreview(screen_pos, img_width, img_height);
     HandleImageClick(screen_pos, img_width, img_height);
 
     ImGui::EndChild();
@@ -251,9 +421,65 @@ void GUI::RenderOverlay(const ImVec2& image_pos, float displayed_width, float di
     draw_list->AddCircleFilled(GridToScreen(image.GetStartPosition()), _marker_size, ImGui::ColorConvertFloat4ToU32(_start_marker_color));
     draw_list->AddCircleFilled(GridToScreen(image.GetEndPosition()), _marker_size, ImGui::ColorConvertFloat4ToU32(_end_marker_color));
 
+    // Straight runs are a single segment, so only the corners are kept
+    if (_overlay.path_dirty) {
+        ProfileZone zone("Overlay Build");
+
+        auto CollectCorners = [](const CompactPath& path, std::vector<ImVec2>& corners) {
+            path.ForEachCorner([&](int x, int y) {
+                corners.emplace_back(float(x), float(y));
+            });
+        };
+
+        _overlay.corners.assign(1 + _agent_result.paths.size(), {});
+        CollectCorners(_solved_path, _overlay.corners[0]);
+
+        for (size_t i = 0; i < _agent_result.paths.size(); ++i) {
+            CollectCorners(_agent_result.paths[i].ToCompactPath(image.GetWidth()), _overlay.corners[i + 1]);
+        }
+
+        _overlay.path_dirty = false;
+        _overlay.view_dirty = true;
+    }
+
+    ImVec2 displayed_size(displayed_width, displayed_height);
+    if (_overlay.view_dirty || _overlay.image_pos.x != image_pos.x || _overlay.image_pos.y != image_pos.y
+        || _overlay.displayed_size.x != displayed_size.x || _overlay.displayed_size.y != displayed_size.y) {
+        ProfileZone zone("Overlay Build");
+
+        _overlay.points.resize(_overlay.corners.size());
+        for (size_t i = 0; i < _overlay.corners.size(); ++i) {
+            _overlay.points[i].resize(_overlay.corners[i].size());
+            for (size_t j = 0; j < _overlay.corners[i].size(); ++j) {
+                _overlay.points[i][j] = GridToScreen(_overlay.corners[i][j]);
+            }
+        }
+        _overlay.image_pos = image_pos;
+        _overlay.displayed_size = displayed_size;
+        _overlay.view_dirty = false;
+    }
+
     _path_color.w = _path_alpha;
-    for (size_t i = 1; i < _solved_path.size(); ++i) {
-        draw_list->AddLine(GridToScreen(_solved_path[i - 1]), GridToScreen(_solved_path[i]), ImGui::ColorConvertFloat4ToU32(_path_color), _path_thickness);
+    for (size_t i = 0; i < _overlay.points.size(); ++i) {
+        const std::vector<ImVec2>& points = _overlay.points[i];
+        if (points.size() < 2) continue;
+
+        ImVec4 color = i == 0 ? _path_color : GetAgentColor(i - 1);
+        ImU32 packed_color = ImGui::ColorConvertFloat4ToU32(color);
+
+        // Thick polylines take up to four vertices per point and draw indices are 16-bit,
+        // so long paths go out in chunks that share their end point
+        for (size_t begin = 0; begin + 1 < points.size(); begin += max_polyline_points - 1) {
+            size_t count = std::min(max_polyline_points, points.size() - begin);
+            draw_list->AddPolyline(points.data() + begin, int(count), packed_color, ImDrawFlags_None, _path_thickness);
+        }
+    }
+
+    // Agents get a filled start and a hollow goal in their own colour
+    for (size_t i = 0; i < _agents.size(); ++i) {
+        ImU32 color = ImGui::ColorConvertFloat4ToU32(GetAgentColor(i));
+        draw_list->AddCircleFilled(GridToScreen(_agents[i].start), _marker_size * 0.6f, color);
+        draw_list->AddCircle(GridToScreen(_agents[i].goal), _marker_size * 0.6f, color, 0, 1.5f);
     }
 
     if (_bounding_box) {
@@ -266,6 +492,11 @@ void GUI::RenderOverlay(const ImVec2& image_pos, float displayed_width, float di
     }
 }
 
+void GUI::SetSolvedPath(CompactPath path) {
+    _solved_path = std::move(path);
+    _overlay.path_dirty = true;
+}
+
 void GUI::RenderAdvancedSettings() {
     if (ImGui::CollapsingHeader("Advanced Settings")) {
         ImGui::Text("Path Settings");
@@ -284,6 +515,16 @@ void GUI::RenderAdvancedSettings() {
             ImGui::ColorEdit3("Bounding Box", (float*)&_bounding_box_color);
         }
 
+        ImGui::Separator();
+        ImGui::Text("Cache Settings");
+        if (ImGui::Checkbox("Persistent Grid Cache", &_persistent_cache)) {
+            grid_cache.SetEnabled(_persistent_cache);
+        }
+        ImGui::Text("Solve cache: %zu entries, %zu hits, %zu misses", solve_cache.GetSize(), solve_cache.GetHits(), solve_cache.GetMisses());
+        if (ImGui::Button("Clear Solve Cache")) {
+            solve_cache.Clear();
+        }
+
         ImGui::Separator();
         if (ImGui::Button("Reset Defaults")) {
             _path_alpha = 0.8f;
@@ -297,24 +538,515 @@ void GUI::RenderAdvancedSettings() {
     }
 
     ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
-    ImGui::Text("Path size: %i", _solved_path.size());
+    ImGui::SameLine();
+    ImGui::Checkbox("Show Profiler", &_show_profiler);
+    ImGui::Text("Path size: %zu (%zu bytes)", _solved_path.GetLength(), _solved_path.GetMemoryUsage());
     ImGui::Text("Solve time: %.2f ms", _solve_time);
+    if (distance_field.IsValidFor(_maze_hash, image.GetEndPosition())) {
+        ImGui::Text("Goal field build: %.2f ms", distance_field.GetBuildTime());
+    }
+    if (clearance_map.IsValidFor(_maze_hash)) {
+        ImGui::Text("Clearance map: widest %.1f px, built in %.2f ms", clearance_map.GetMaxClearance(), clearance_map.GetBuildTime());
+    }
+    if (pyramid.IsValidFor(_maze_hash)) {
+        ImGui::Text("Pyramid: %zu levels, built in %.2f ms", pyramid.GetLevelCount(), pyramid.GetBuildTime());
+    }
+    if (_algorithm == Alg::Pyramid && !_pyramid_result.path.Empty()) {
+        const MazePyramid::Result& result = _pyramid_result;
+        ImGui::Text("Coarse level %d, %zu corridor cells%s", result.coarse_level, result.corridor_cells, result.fell_back ? ", fell back" : "");
+
+        if (result.gap_measured) {
+            size_t gap = result.path.GetLength() - result.optimal_length;
+            ImGui::Text("Optimality gap: +%zu steps (%.2f%%), full search %.2f ms", gap, 100.0 * gap / result.optimal_length, result.full_solve_time);
+        }
+    }
+}
+
+// Builds the walkability grid for the loaded image, reusing the on-disk cache when possible
+void GUI::ConvertMaze() {
+    uint64_t source_hash = _threshold_settings.Hash(image.GetSourceHash());
+    std::pair<ImVec2, ImVec2> bounding_box;
+
+    if (grid_cache.Load(source_hash, _maze, _components, bounding_box)) {
+        image.SetBoundingBox(bounding_box);
+    }
+    else {
+        if (!thresholder.HasSource()) {
+            thresholder.SetSource(image.GetImageData(), image.GetWidth(), image.GetHeight());
+        }
+
+        _maze = image.MaskToMazeGrid(thresholder.Apply(_threshold_settings));
+        _components = pathfinder.LabelComponents(_maze);
+        grid_cache.Store(source_hash, _maze, _components, image.CalculateMazeBoundingBox());
+    }
+
+    _component_sizes = pathfinder.MeasureComponents(_components);
+    _maze_hash = HashMazeGrid(_maze);
+    pyramid.Build(_maze, _maze_hash, ThreadPool::Shared());
+    clearance_map.Build(_maze, _maze_hash, ThreadPool::Shared());
+    SetSolvedPath({});
+    ClearAgents();
+}
+
+void GUI::RenderThresholdSettings() {
+    if (!ImGui::CollapsingHeader("Threshold")) {
+        return;
+    }
+
+    ThresholdSettings& settings = _threshold_settings;
+    bool changed = false;
+
+    const char* modes[] = { "Fixed", "Otsu", "Sauvola", "Bradley" };
+    changed |= ImGui::Combo("Mode", (int*)&settings.mode, modes, IM_ARRAYSIZE(modes));
+
+    switch (settings.mode) {
+    case ThresholdSettings::Mode::Fixed:
+        changed |= ImGui::SliderInt("Level", &settings.level, 0, 255);
+        break;
+    case ThresholdSettings::Mode::Otsu:
+        if (thresholder.HasSource()) {
+            ImGui::Text("Otsu level: %d", thresholder.GetOtsuLevel());
+        }
+        break;
+    case ThresholdSettings::Mode::Sauvola:
+        changed |= ImGui::SliderInt("Window Radius", &settings.window_radius, 1, 100);
+        changed |= ImGui::SliderFloat("k", &settings.sauvola_k, 0.01f, 0.5f, "%.2f");
+        break;
+    case ThresholdSettings::Mode::Bradley:
+        changed |= ImGui::SliderInt("Window Radius", &settings.window_radius, 1, 100);
+        changed |= ImGui::SliderFloat("t", &settings.bradley_t, 0.0f, 0.5f, "%.2f");
+        break;
+    }
+
+    changed |= ImGui::SliderInt("Open Radius", &settings.open_radius, 0, 5);
+    changed |= ImGui::SliderInt("Close Radius", &settings.close_radius, 0, 5);
+    changed |= ImGui::Checkbox("Live Preview", &_threshold_preview);
+
+    // Only the O(1) per pixel classification reruns while a slider moves
+    if (_threshold_preview && (changed || image.GetPreviewTexture() == 0)) {
+        if (!thresholder.HasSource()) {
+            thresholder.SetSource(image.GetImageData(), image.GetWidth(), image.GetHeight());
+        }
+        image.UpdatePreviewTexture(thresholder.Apply(settings));
+    }
+
+    if (ImGui::Button("Apply Threshold", ImVec2(-1, 0))) {
+        ConvertMaze();
+    }
+}
+
+void GUI::RenderBatchPanel() {
+    size_t item_count = batch_queue.GetItemCount();
+    if (item_count == 0 || !ImGui::CollapsingHeader("Batch", ImGuiTreeNodeFlags_DefaultOpen)) {
+        return;
+    }
+
+    ImGui::Text("Processed: %zu / %zu", batch_queue.GetFinishedCount(), item_count);
+
+    ImGui::BeginChild("BatchItems", ImVec2(0, 150), true);
+    for (size_t i = 0; i < item_count; ++i) {
+        const BatchQueue::Item& item = batch_queue.GetItem(i);
+        BatchQueue::Status status = item.status.load();
+
+        std::string name = std::filesystem::path(item.filename).filename().string();
+        std::string label = status == BatchQueue::Status::Solved
+            ? std::format("{} - {} ({} steps, {:.1f} ms)##{}", name, BatchQueue::GetStatusName(status), item.path.GetLength(), item.solve_time, i)
+            : std::format("{} - {}##{}", name, BatchQueue::GetStatusName(status), i);
+
+        ImGui::BeginDisabled(!item.IsFinished() || status == BatchQueue::Status::Failed);
+        if (ImGui::Selectable(label.c_str(), _viewed_batch_item == int(i))) {
+            ViewBatchItem(i);
+        }
+        ImGui::EndDisabled();
+    }
+    ImGui::EndChild();
+
+    ImGui::BeginDisabled(batch_queue.IsBusy());
+    if (ImGui::Button("Clear Batch", ImVec2(-1, 0))) {
+        batch_queue.Clear();
+        _viewed_batch_item = -1;
+    }
+    ImGui::EndDisabled();
+}
+
+// Items keep only their results, so the viewed one is decoded again and its grid
+// comes from the grid cache when the batch stored it there
+void GUI::ViewBatchItem(size_t index) {
+    const BatchQueue::Item& item = batch_queue.GetItem(index);
+
+    if (!image.LoadTextureFromFile(item.filename)) {
+        return;
+    }
+
+    image.ApplyGreyscaleFilter();
+    image.SetStartPosition(item.start_pos);
+    image.SetEndPosition(item.end_pos);
+    _image_texture = image.GetTexture();
+
+    thresholder.Reset();
+    _threshold_settings = item.threshold;
+    ConvertMaze();
+
+    // The file may have changed on disk since the batch solved it
+    if (_maze_hash == item.maze_hash) {
+        SetSolvedPath(item.path);
+        _solve_time = item.solve_time;
+    }
+    _viewed_batch_item = int(index);
+}
+
+void GUI::RenderMultiAgentPanel() {
+    if (!ImGui::CollapsingHeader("Multi-Agent")) {
+        return;
+    }
+
+    ImGui::Text("Agents: %zu", _agents.size());
+
+    if (ImGui::Button("Add Start/End as Agent", ImVec2(-1, 0))) {
+        _agents.push_back({ image.GetStartPosition(), image.GetEndPosition() });
+        _agent_result = {};
+        _overlay.path_dirty = true;
+    }
+
+    ImGui::SliderInt("Count", &_random_agent_count, 1, 500);
+    if (ImGui::Button("Add Random Agents", ImVec2(-1, 0))) {
+        AddRandomAgents(_random_agent_count);
+    }
+
+    ImGui::RadioButton("Prioritized", (int*)&_agent_method, (int)MultiAgentPlanner::Method::Prioritized);
+    ImGui::SameLine();
+    ImGui::RadioButton("CBS", (int*)&_agent_method, (int)MultiAgentPlanner::Method::ConflictBased);
+
+    if (_agent_method == MultiAgentPlanner::Method::ConflictBased && _agents.size() > MultiAgentPlanner::cbs_agent_limit) {
+        ImGui::TextDisabled("CBS handles up to %zu agents, larger fleets use prioritized planning", MultiAgentPlanner::cbs_agent_limit);
+    }
+
+    float button_width = (ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ItemSpacing.x) * 0.5f;
+
+    ImGui::BeginDisabled(_agents.empty());
+    if (ImGui::Button("Plan Agents", ImVec2(button_width, 0))) {
+        MultiAgentPlanner planner(_maze, ThreadPool::Shared());
+        _agent_result = planner.Plan(_agents, _agent_method);
+        _overlay.path_dirty = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear Agents", ImVec2(button_width, 0))) {
+        ClearAgents();
+    }
+    ImGui::EndDisabled();
+
+    if (!_agent_result.paths.empty()) {
+        const char* method = _agent_result.method == MultiAgentPlanner::Method::ConflictBased ? "CBS" : "Prioritized";
+        ImGui::Text("%s: %zu / %zu routed", method, _agent_result.paths.size() - _agent_result.failed, _agent_result.paths.size());
+        ImGui::Text("Makespan: %zu, sum of costs: %zu", _agent_result.makespan, _agent_result.sum_of_costs);
+        ImGui::Text("Plan time: %.2f ms, %zu expansions", _agent_result.plan_time, _agent_result.expanded);
+        if (_agent_result.cbs_nodes) {
+            ImGui::Text("CBS nodes: %zu", _agent_result.cbs_nodes);
+        }
+    }
+}
+
+// Agents are drawn from the largest component so every pair can at least reach each other
+void GUI::AddRandomAgents(int count) {
+    if (_component_sizes.size() < 2) {
+        return;
+    }
+
+    int32_t largest = int32_t(std::max_element(_component_sizes.begin() + 1, _component_sizes.end()) - _component_sizes.begin());
+    int width = image.GetWidth();
+
+    std::vector<int32_t> cells;
+    for (size_t i = 0; i < _components.size(); ++i) {
+        if (_components[i] == largest) cells.push_back(int32_t(i));
+    }
+
+    // Starts and goals must all be distinct, including those of agents already placed
+    std::unordered_set<int32_t> used;
+    for (const MultiAgentPlanner::Agent& agent : _agents) {
+        used.insert(int32_t(agent.start.y) * width + int32_t(agent.start.x));
+        used.insert(int32_t(agent.goal.y) * width + int32_t(agent.goal.x));
+    }
+
+    std::mt19937 rng(std::random_device{}());
+    std::shuffle(cells.begin(), cells.end(), rng);
+
+    size_t next = 0;
+    auto Take = [&]() -> int32_t {
+        while (next < cells.size()) {
+            int32_t cell = cells[next++];
+            if (used.insert(cell).second) return cell;
+        }
+        return -1;
+    };
+
+    for (int i = 0; i < count; ++i) {
+        int32_t start = Take();
+        int32_t goal = Take();
+        if (goal < 0) break;
+
+        _agents.push_back({ ImVec2(float(start % width), float(start / width)), ImVec2(float(goal % width), float(goal / width)) });
+    }
+
+    _agent_result = {};
+    _overlay.path_dirty = true;
+}
+
+void GUI::ClearAgents() {
+    _agents.clear();
+    _agent_result = {};
+    _overlay.path_dirty = true;
+}
+
+// Golden-ratio hue steps keep neighbouring agents apart for any fleet size
+ImVec4 GUI::GetAgentColor(size_t index) const {
+    ImVec4 color(0.0f, 0.0f, 0.0f, _path_alpha);
+    float hue = std::fmod(0.61803398875f * float(index), 1.0f);
+    ImGui::ColorConvertHSVtoRGB(hue, 0.75f, 0.95f, color.x, color.y, color.z);
+    return color;
+}
+
+// Frame-time graph, a per-thread timeline of the most recent zones and per-zone totals
+void GUI::RenderProfilerWindow() {
+    Profiler& profiler = Profiler::Shared();
+
+    ImGui::SetNextWindowSize(ImVec2(800, 500), ImGuiCond_Once);
+    if (!ImGui::Begin("Profiler", &_show_profiler)) {
+        ImGui::End();
+        return;
+    }
+
+    bool enabled = profiler.IsEnabled();
+    if (ImGui::Checkbox("Record", &enabled)) {
+        profiler.SetEnabled(enabled);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause View", &_profiler_paused);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear")) {
+        profiler.Clear();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome Trace")) {
+        const char* filter[1] = { "*.json" };
+        const char* file_path = tinyfd_saveFileDialog("Export Chrome Trace", "trace.json", 1, filter, nullptr);
+        if (file_path) profiler.ExportChromeTrace(file_path);
+    }
+
+    const std::vector<float>& frame_times = profiler.GetFrameTimes();
+    if (!frame_times.empty()) {
+        float total = 0.0f, longest = 0.0f;
+        for (float time : frame_times) {
+            total += time;
+            longest = std::max(longest, time);
+        }
+
+        std::string overlay = std::format("avg {:.2f} ms, max {:.2f} ms", total / frame_times.size(), longest);
+        ImGui::PlotLines("##frame_times", frame_times.data(), int(frame_times.size()), int(profiler.GetFrameOffset()), overlay.c_str(), 0.0f, std::max(longest, 16.7f), ImVec2(-1, 60));
+    }
+
+    ImGui::SliderFloat("Window (ms)", &_profiler_window_ms, 5.0f, 2000.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+    ImGui::Text("%zu zones from %zu threads, %zu dropped", profiler.GetZoneCount(), profiler.GetThreadCount(), profiler.GetDroppedCount());
+
+    if (!_profiler_paused || _profiler_view_end == 0) {
+        _profiler_view_end = Profiler::Now();
+    }
+    uint64_t window_ns = uint64_t(_profiler_window_ms * 1e6);
+    uint64_t view_start = _profiler_view_end > window_ns ? _profiler_view_end - window_ns : 0;
+
+    // Rings are drained thread by thread, so the history is not sorted by time
+    std::vector<Profiler::Zone> zones = profiler.GetZones(view_start, _profiler_view_end);
+    std::vector<const Profiler::Zone*> visible;
+    std::vector<uint32_t> lanes(profiler.GetThreadCount(), 0);
+    for (const Profiler::Zone& zone : zones) {
+        visible.push_back(&zone);
+        if (zone.thread_id >= lanes.size()) lanes.resize(zone.thread_id + 1, 0);
+        lanes[zone.thread_id] = std::max(lanes[zone.thread_id], zone.depth + 1);
+    }
+
+    const float lane_height = ImGui::GetTextLineHeight() + 4.0f;
+    const float label_width = 70.0f;
+
+    std::vector<float> row_offsets(lanes.size(), 0.0f);
+    float timeline_height = 0.0f;
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        row_offsets[i] = timeline_height;
+        if (lanes[i] > 0) timeline_height += lanes[i] * lane_height + 4.0f;
+    }
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float timeline_width = std::max(ImGui::GetContentRegionAvail().x - label_width, 1.0f);
+    float ns_to_px = timeline_width / float(window_ns);
+
+    ImGui::InvisibleButton("##timeline", ImVec2(label_width + timeline_width, std::max(timeline_height, lane_height)));
+    bool hovered = ImGui::IsItemHovered();
+    ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    for (size_t i = 0; i < lanes.size(); ++i) {
+        if (lanes[i] == 0) continue;
+        draw_list->AddText(ImVec2(origin.x, origin.y + row_offsets[i]), ImGui::GetColorU32(ImGuiCol_Text), std::format("Thread {}", i).c_str());
+    }
+
+    const Profiler::Zone* hovered_zone = nullptr;
+    for (const Profiler::Zone* zone : visible) {
+        float x0 = origin.x + label_width + float(double(std::max(zone->start_ns, view_start) - view_start) * ns_to_px);
+        float x1 = origin.x + label_width + float(double(std::min(zone->end_ns, _profiler_view_end) - view_start) * ns_to_px);
+        float y0 = origin.y + row_offsets[zone->thread_id] + zone->depth * lane_height;
+        x1 = std::max(x1, x0 + 1.0f);
+
+        // Colour follows the name so a zone keeps its colour across frames and threads
+        float hue = float(HashBytes(zone->name, std::strlen(zone->name)) % 1000) / 1000.0f;
+        ImU32 color = ImColor::HSV(hue, 0.55f, 0.85f);
+
+        ImVec2 min(x0, y0), max(x1, y0 + lane_height - 1.0f);
+        draw_list->AddRectFilled(min, max, color);
+        if (x1 - x0 > 30.0f) {
+            draw_list->PushClipRect(min, max, true);
+            draw_list->AddText(ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(0, 0, 0, 255), zone->name);
+            draw_list->PopClipRect();
+        }
+
+        if (hovered && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+            hovered_zone = zone;
+        }
+    }
+
+    if (hovered_zone) {
+        ImGui::SetTooltip("%s\n%.3f ms on thread %u", hovered_zone->name, (hovered_zone->end_ns - hovered_zone->start_ns) / 1e6, hovered_zone->thread_id);
+    }
+
+    struct ZoneStats {
+        size_t count = 0;
+        double total_ms = 0.0;
+        double max_ms = 0.0;
+    };
+
+    std::unordered_map<std::string_view, ZoneStats> stats;
+    for (const Profiler::Zone* zone : visible) {
+        ZoneStats& entry = stats[zone->name];
+        double duration = (zone->end_ns - zone->start_ns) / 1e6;
+        ++entry.count;
+        entry.total_ms += duration;
+        entry.max_ms = std::max(entry.max_ms, duration);
+    }
+
+    std::vector<std::pair<std::string_view, ZoneStats>> rows(stats.begin(), stats.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) {
+        return a.second.total_ms > b.second.total_ms;
+    });
+
+    if (ImGui::BeginTable("##zone_stats", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Count");
+        ImGui::TableSetupColumn("Total (ms)");
+        ImGui::TableSetupColumn("Avg (ms)");
+        ImGui::TableSetupColumn("Max (ms)");
+        ImGui::TableHeadersRow();
+
+        for (const auto& [name, entry] : rows) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name.data(), name.data() + name.size());
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", entry.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", entry.total_ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", entry.total_ms / entry.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", entry.max_ms);
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
+
+void GUI::RenderExportSettings() {
+    if (_solved_path.Empty() || !ImGui::CollapsingHeader("Export Path")) {
+        return;
+    }
+
+    auto SaveDialog = [](const char* title, const char* default_name, const char* pattern) -> std::string {
+        const char* filter[1] = { pattern };
+        const char* file_path = tinyfd_saveFileDialog(title, default_name, 1, filter, nullptr);
+        return file_path ? file_path : "";
+    };
+
+    float button_width = (ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ItemSpacing.x) * 0.5f;
+
+    if (ImGui::Button("CSV", ImVec2(button_width, 0))) {
+        std::string file_path = SaveDialog("Export Path as CSV", "path.csv", "*.csv");
+        if (!file_path.empty()) PathExporter::ExportCsv(_solved_path, file_path);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("JSON", ImVec2(button_width, 0))) {
+        std::string file_path = SaveDialog("Export Path as JSON", "path.json", "*.json");
+        if (!file_path.empty()) PathExporter::ExportJson(_solved_path, file_path);
+    }
+
+    if (ImGui::Button("SVG", ImVec2(button_width, 0))) {
+        std::string file_path = SaveDialog("Export Path as SVG", "path.svg", "*.svg");
+        if (!file_path.empty()) PathExporter::ExportSvg(_solved_path, image.GetWidth(), image.GetHeight(), _path_color, _path_thickness, file_path);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("PNG", ImVec2(button_width, 0))) {
+        std::string file_path = SaveDialog("Export Annotated PNG", "path.png", "*.png");
+        if (!file_path.empty()) PathExporter::ExportPng(_solved_path, image.GetImageData(), image.GetWidth(), image.GetHeight(), _path_color, int(_path_thickness), file_path);
+    }
+}
+
+ImVec2 GUI::ScreenToGrid(const ImVec2& image_pos, float displayed_width, float displayed_height, const ImVec2& screen_pos) {
+    float frac_x = (screen_pos.x - image_pos.x) / displayed_width;
+    float frac_y = (screen_pos.y - image_pos.y) / displayed_height;
+
+    return ImVec2(float(static_cast<int>(frac_x * image.GetWidth())), float(static_cast<int>(frac_y * image.GetHeight())));
+}
+
+// Rebuilt only when the grid or the goal has changed since the last build
+const DistanceField& GUI::GetDistanceField() {
+    if (!distance_field.IsValidFor(_maze_hash, image.GetEndPosition())) {
+        distance_field.Build(_maze, _maze_hash, image.GetEndPosition(), ThreadPool::Shared());
+    }
+    return distance_field;
+}
+
+void GUI::RenderHoverPreview(const ImVec2& image_pos, float displayed_width, float displayed_height) {
+    if (!_hover_preview || !ImGui::IsItemHovered()) {
+        return;
+    }
+
+    ImVec2 grid_pos = ScreenToGrid(image_pos, displayed_width, displayed_height, ImGui::GetMousePos());
+    CompactPath preview = GetDistanceField().Descend(grid_pos);
+
+    ImDrawList* draw_list = ImGui::GetWindowDrawList();
+    ImVec4 color = _path_color;
+    color.w = _path_alpha * 0.5f;
+    ImU32 preview_color = ImGui::ColorConvertFloat4ToU32(color);
+
+    bool has_previous = false;
+    ImVec2 previous;
+
+    preview.ForEachCorner([&](int x, int y) {
+        ImVec2 current(image_pos.x + (x / float(image.GetWidth())) * displayed_width,
+            image_pos.y + (y / float(image.GetHeight())) * displayed_height);
+        if (has_previous) {
+            draw_list->AddLine(previous, current, preview_color, _path_thickness);
+        }
+        previous = current;
+        has_previous = true;
+    });
+
+    ImGui::SetTooltip("(%d, %d) %zu steps to goal", int(grid_pos.x), int(grid_pos.y), preview.GetMoveCount());
 }
 
 void GUI::HandleImageClick(const ImVec2& image_pos, float displayed_width, float displayed_height)
 {
     if (ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left))
     {
-        ImVec2 mouse_screen = ImGui::GetMousePos();
-
-        float local_x = mouse_screen.x - image_pos.x;
-        float local_y = mouse_screen.y - image_pos.y;
-
-        float frac_x = local_x / displayed_width;
-        float frac_y = local_y / displayed_height;
-
-        int grid_x = static_cast<int>(frac_x * image.GetWidth());
-        int grid_y = static_cast<int>(frac_y * image.GetHeight());
+        ImVec2 grid_pos = ScreenToGrid(image_pos, displayed_width, displayed_height, ImGui::GetMousePos());
+        int grid_x = static_cast<int>(grid_pos.x);
+        int grid_y = static_cast<int>(grid_pos.y);
 
         auto [minPos, maxPos] = image.CalculateMazeBoundingBox();
         int minX = static_cast<int>(minPos.x);
@@ -326,12 +1058,20 @@ void GUI::HandleImageClick(const ImVec2& image_pos, float displayed_width, float
         if (grid_x < minX || grid_x > maxX || grid_y < minY || grid_y > maxY)
             return;
 
+        // A click on a wall moves to the nearest cell with room around it in the same corridor;
+        // one on a stray speck moves to the nearest corridor instead
+        ImVec2 position(grid_x, grid_y);
+        if (_snap_endpoints && clearance_map.IsValidFor(_maze_hash)) {
+            float required = _algorithm == Alg::Clearance ? std::max(_snap_clearance, _min_clearance) : _snap_clearance;
+            clearance_map.Snap(position, required, _components, _component_sizes);
+        }
+
         if (_current_mode == PositionMode::SetStart) {
-            image.SetStartPosition(ImVec2(grid_x, grid_y));
+            image.SetStartPosition(position);
             _current_mode = PositionMode::None;
         }
         else if (_current_mode == PositionMode::SetEnd) {
-            image.SetEndPosition(ImVec2(grid_x, grid_y));
+            image.SetEndPosition(position);
             _current_mode = PositionMode::None;
         }
     }
@@ -383,4 +1123,39 @@ void GUI::SetupImGuiStyle() {
 
 bool GUI::IsRunning() const {
     return _running;
+}
+
+// ImGui needs a few frames after an input for hover and layout state to settle
+void GUI::RequestRedraw() {
+    _redraw_frames = 3;
+}
+
+// The GLFW callbacks queue input in ImGui and flag moved or resized platform windows,
+// so a wake-up that left neither behind was a timeout or spurious and needs no frame
+bool GUI::HasPendingEvents() const {
+    if (!ImGui::GetCurrentContext()->InputEventsQueue.empty()) {
+        return true;
+    }
+
+    for (ImGuiViewport* viewport : ImGui::GetPlatformIO().Viewports) {
+        if (viewport->PlatformRequestMove || viewport->PlatformRequestResize || viewport->PlatformRequestClose) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stays true for one frame after the queue drains so the final results get drawn
+bool GUI::IsBusy() const {
+    return _was_busy || batch_queue.IsBusy();
+}
+
+// Seconds the main loop may block waiting for input, 0 to render again immediately
+double GUI::GetIdleTimeout() const {
+    if (_redraw_frames > 0 || ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput) {
+        return 0.0;
+    }
+
+    // Background jobs have no window events, so refresh their progress periodically
+    return IsBusy() ? 0.1 : 0.5;
 }
\ No newline at end of file
@@ -4,6 +4,14 @@
 #include <imgui.h>
 #include <GLFW/glfw3.h>
 #include <vector>
+#include <cstdint>
+
+#include "../../path/path.hpp"
+#include "../../image/threshold.hpp"
+#include "../../pathfinder/multi_agent.hpp"
+#include "../../pathfinder/pyramid.hpp"
+
+class DistanceField;
 
 class GUI {
 public:
@@ -15,7 +23,10 @@ public:
 
     enum class Alg { 
         Dijkstra = 0, 
-        AStar
+        AStar,
+        DistanceField,
+        Pyramid,
+        Clearance
     };
 
     GUI();
@@ -28,19 +39,47 @@ public:
     void Render();
     bool IsRunning() const;
 
+    void RequestRedraw();
+    bool HasPendingEvents() const;
+    bool IsBusy() const;
+    double GetIdleTimeout() const;
+
 private:
     bool _running;
     PositionMode _current_mode;
-    std::vector<ImVec2> _solved_path;
+    CompactPath _solved_path;
     std::vector<std::vector<int>> _maze;
+    std::vector<int32_t> _components;
+    std::vector<size_t> _component_sizes;
+    uint64_t _maze_hash;
     GLuint _image_texture;
     double _solve_time;
     bool _show_popup;
+    const char* _popup_message;
+    int _redraw_frames;
+    bool _was_busy;
+
+    // Screen-space path geometry, rebuilt only when a path or the view changes.
+    // The solved path comes first, followed by one polyline per planned agent.
+    struct OverlayGeometry {
+        std::vector<std::vector<ImVec2>> corners;
+        std::vector<std::vector<ImVec2>> points;
+        ImVec2 image_pos;
+        ImVec2 displayed_size;
+        bool path_dirty = true;
+        bool view_dirty = true;
+    };
+
+    OverlayGeometry _overlay;
 
     void SetupImGuiStyle();
     void RenderControlsPanel();
     void RenderImagePanel();
+    void SetSolvedPath(CompactPath path);
     void RenderOverlay(const ImVec2& image_pos, float img_width, float img_height);
+    void RenderHoverPreview(const ImVec2& image_pos, float displayed_width, float displayed_height);
+    ImVec2 ScreenToGrid(const ImVec2& image_pos, float displayed_width, float displayed_height, const ImVec2& screen_pos);
+    const DistanceField& GetDistanceField();
     void HandleImageClick(const ImVec2& image_pos, float displayed_width, float displayed_height);
     void HandleZoom();
     void HandlePanning();
@@ -59,9 +98,46 @@ private:
     bool _bounding_box;
     ImVec4 _bounding_box_color;
 
+    bool _persistent_cache;
+
     Alg _algorithm;
 
     void RenderAdvancedSettings();
+    void RenderExportSettings();
+    void RenderBatchPanel();
+    void RenderThresholdSettings();
+    void ConvertMaze();
+    void ViewBatchItem(size_t index);
+    void RenderMultiAgentPanel();
+    void AddRandomAgents(int count);
+    void ClearAgents();
+    ImVec4 GetAgentColor(size_t index) const;
+    void RenderProfilerWindow();
+
+    int _viewed_batch_item;
+
+    bool _hover_preview;
+
+    ThresholdSettings _threshold_settings;
+    bool _threshold_preview;
+
+    std::vector<MultiAgentPlanner::Agent> _agents;
+    MultiAgentPlanner::Result _agent_result;
+    MultiAgentPlanner::Method _agent_method;
+    int _random_agent_count;
+
+    bool _measure_gap;
+    MazePyramid::Result _pyramid_result;
+
+    bool _snap_endpoints;
+    float _snap_clearance;
+    float _min_clearance;
+    float _wall_penalty;
+
+    bool _show_profiler;
+    bool _profiler_paused;
+    float _profiler_window_ms;
+    uint64_t _profiler_view_end;
 };
 
 #endif // GUI_HPP
\ No newline at end of file
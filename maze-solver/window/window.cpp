@@ -34,6 +34,11 @@ void Window::PollEvents() {
     glfwPollEvents();
 }
 
+// Blocks until input arrives or the timeout expires
+void Window::WaitEvents(double timeout) {
+    glfwWaitEventsTimeout(timeout);
+}
+
 bool Window::ShouldClose(GLFWwindow* window) {
     return glfwWindowShouldClose(window);
 }
\ No newline at end of file
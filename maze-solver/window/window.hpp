@@ -8,6 +8,7 @@ public:
     GLFWwindow* CreateWindow(int width, int height, const char* title);
     void DestroyWindow(GLFWwindow* window);
     void PollEvents();
+    void WaitEvents(double timeout);
     bool ShouldClose(GLFWwindow* window);
 };
 